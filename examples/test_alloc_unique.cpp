@@ -0,0 +1,52 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/alloc_unique.h>
+#include <micro-alloc/std_rebind_allocator.h>
+#include <micro-alloc/static_linear_allocator.h>
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/dynamic_memory.h>
+#include <iostream>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+struct item {
+    int id;
+    explicit item(int id=0) : id(id) {}
+    ~item() { std::cout << "- item #" << id << " destroyed\n"; }
+};
+
+// stateless allocators cost zero bytes, a polymorphic allocator only it's resource pointer
+static_assert(sizeof(alloc_unique<item, std_rebind_allocator<>>) == sizeof(void *), "");
+static_assert(sizeof(alloc_unique<item, static_linear_allocator<>>) == sizeof(void *), "");
+static_assert(sizeof(alloc_unique<item, polymorphic_allocator<>>) == 2 * sizeof(void *), "");
+
+void test_stateless() {
+    auto p1 = make_alloc_unique<item>(std_rebind_allocator<>(), 1);
+    auto p2 = make_alloc_unique<item>(std_rebind_allocator<>(), 2);
+    p2 = micro_alloc::traits::move(p1);
+    auto array = make_alloc_unique<item[]>(std_rebind_allocator<>(), 3, 3);
+    if (p1 || p2->id != 1 || array[2].id != 3) throw "bad ownership";
+}
+
+void test_polymorphic() {
+    const int size = 5000;
+    byte memory[size];
+    dynamic_memory dynamic{memory, size};
+    polymorphic_allocator<> allocator{&dynamic};
+
+    const auto available = dynamic.available_size();
+    {
+        auto p1 = make_alloc_unique<item>(allocator, 4);
+        alloc_unique<item, polymorphic_allocator<>> p2{allocator};
+        p2 = micro_alloc::traits::move(p1);
+        auto array = make_alloc_unique<item[]>(allocator, 2, 5);
+    }
+    if (dynamic.available_size() != available) throw "memory was not returned to the resource";
+}
+
+int main() {
+    test_stateless();
+    test_polymorphic();
+}
@@ -0,0 +1,90 @@
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/std_rebind_allocator.h>
+#include <micro-alloc/static_linear_allocator.h>
+#include <micro-alloc/node_pool_allocator.h>
+#include <micro-alloc/dynamic_memory.h>
+#include <micro-alloc/std_memory.h>
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <vector>
+
+using namespace micro_alloc;
+
+struct item {
+    static long moves;
+    long value;
+    item(long v) : value(v) {}
+    item(const item & o) : value(o.value) { moves++; }
+    item(item && o) noexcept : value(o.value) { moves++; }
+    item & operator=(const item & o) { value = o.value; moves++; return *this; }
+    item & operator=(item && o) noexcept { value = o.value; moves++; return *this; }
+};
+long item::moves = 0;
+
+template<class Alloc>
+using traits_of = std::allocator_traits<Alloc>;
+
+static_assert(traits_of<std_rebind_allocator<int>>::is_always_equal::value, "");
+static_assert(traits_of<std_rebind_allocator<int>>::propagate_on_container_move_assignment::value, "");
+static_assert(traits_of<static_linear_allocator<int>>::is_always_equal::value, "");
+static_assert(traits_of<node_pool_allocator<int>>::is_always_equal::value, "");
+static_assert(!traits_of<polymorphic_allocator<int>>::is_always_equal::value, "");
+static_assert(!traits_of<polymorphic_allocator<int>>::propagate_on_container_move_assignment::value, "");
+
+/**
+ * move assign a container of {count} items {rounds} times
+ * @return element moves per move assignment, and prints the time of a move assignment
+ */
+template<class Container, class Alloc>
+long bench_move_assign(const char * name, const Alloc & a, const Alloc & b, int count, int rounds) {
+    Container from(a), to(b);
+    for (int ix = 0; ix < count; ++ix) from.push_back(item(ix));
+    item::moves = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        to = std::move(from);
+        from = std::move(to);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << name << ": " << ns / (2 * rounds) << " ns per move assignment, "
+              << item::moves / (2 * rounds) << " element moves\n";
+    if (from.size() != (unsigned long)count) throw "lost items";
+    return item::moves / (2 * rounds);
+}
+
+int main() {
+    const int count = 10000, rounds = 50;
+    std_memory heap;
+    std_memory other_heap;
+    static unsigned char memory[1 << 20];
+    dynamic_memory dynamic{memory, sizeof memory};
+
+    // always equal allocators steal the buffers
+    if (bench_move_assign<std::vector<item, std_rebind_allocator<item>>>("vector, std_rebind_allocator",
+            std_rebind_allocator<item>(), std_rebind_allocator<item>(), count, rounds)) throw "vector moved items";
+    if (bench_move_assign<std::list<item, node_pool_allocator<item>>>("list, node_pool_allocator",
+            node_pool_allocator<item>(), node_pool_allocator<item>(), count, rounds)) throw "list moved items";
+
+    // polymorphic allocators compare equal for the same resource, and steal the buffers as well
+    polymorphic_allocator<item> on_heap{&heap}, on_other_heap{&other_heap}, on_dynamic{&dynamic};
+    if (bench_move_assign<std::vector<item, polymorphic_allocator<item>>>("vector, same resource",
+            on_heap, on_other_heap, count, rounds)) throw "vector moved items";
+    if (bench_move_assign<std::list<item, polymorphic_allocator<item>>>("list, same resource",
+            on_heap, on_other_heap, count, rounds)) throw "list moved items";
+
+    // different resources can not free each others memory, so items are moved one by one
+    if (!bench_move_assign<std::vector<item, polymorphic_allocator<item>>>("vector, different resources",
+            on_heap, on_dynamic, count / 10, rounds)) throw "vector stole a buffer of another resource";
+
+    // swaps steal pointers
+    std::vector<item, std_rebind_allocator<item>> a(count, item(1)), b(1, item(2));
+    item::moves = 0;
+    a.swap(b);
+    if (item::moves != 0 || b.size() != (unsigned long)count) throw "bad swap";
+    if (std_rebind_allocator<int>() != std_rebind_allocator<long>()) throw "bad operator!=";
+    if (!(on_heap == polymorphic_allocator<int>(&other_heap)) || on_heap != polymorphic_allocator<int>(&heap))
+        throw "bad operator==";
+}
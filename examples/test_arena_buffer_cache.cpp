@@ -0,0 +1,67 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/arena_buffer_cache.h>
+#include <micro-alloc/std_memory.h>
+#include <micro-alloc/linear_memory.h>
+#include <micro-alloc/dynamic_memory.h>
+#include <thread>
+
+using namespace micro_alloc;
+
+void test_1() {
+    std_memory upstream{};
+    arena_buffer_cache cache{&upstream, 4096, 8};
+    // warm up, so requests never touch the upstream
+    cache.reserve(16384, 2);
+
+    for (int request = 0; request < 3; ++request) {
+        cached_arena<linear_memory> arena{cache, 10000};
+        arena->malloc(5000);
+        arena->malloc(5000);
+        // arena buffer is returned to the cache here
+    }
+
+    // a request arena follows it's request to another thread
+    cached_arena<dynamic_memory> arena{cache, 4096};
+    std::thread worker([](cached_arena<dynamic_memory> request_arena) {
+        void * p = request_arena->malloc(100);
+        request_arena->free(p);
+    }, micro_alloc::traits::move(arena));
+    worker.join();
+}
+
+void test_2() {
+    std_memory upstream{};
+    arena_buffer_cache cache{&upstream, 4096, 8};
+    cached_arena<linear_memory> arena{cache, 4096};
+    void * p = arena->malloc(100);
+
+    // the moved-from arena gives up the buffer and the memory resource on top of it
+    cached_arena<linear_memory> moved{micro_alloc::traits::move(arena)};
+    if (arena || arena.buffer()) throw "moved-from arena can still allocate";
+    if (!moved || moved->malloc(100) == p) throw "moved arena lost it's allocations";
+}
+
+// upstream, that is always out of memory
+struct empty_memory : public memory_resource {
+    void * malloc(uptr) override { return nullptr; }
+    bool free(void *) override { return false; }
+};
+
+void test_3() {
+    empty_memory upstream{};
+    arena_buffer_cache cache{&upstream, 4096, 8};
+
+    // no buffer, so no memory resource is built on top of a null buffer
+    cached_arena<dynamic_memory> arena{cache, 4096};
+    if (arena || arena.buffer()) throw "arena without a buffer looks usable";
+    cached_arena<dynamic_memory> moved{micro_alloc::traits::move(arena)};
+    if (moved) throw "moved arena without a buffer looks usable";
+}
+
+int main() {
+    test_1();
+    test_2();
+    test_3();
+}
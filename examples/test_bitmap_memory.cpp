@@ -0,0 +1,36 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/bitmap_memory.h>
+
+using namespace micro_alloc;
+
+void test_1() {
+    using byte= unsigned char;
+    const int size = 5000;
+    byte memory[size];
+
+    bitmap_memory alloc{memory, size, 16};
+
+    void * a1 = alloc.malloc(200);
+    void * a2 = alloc.malloc(16);
+    void * a3 = alloc.malloc(1);
+    void * a4 = alloc.malloc(100);
+    alloc.free(a2);
+    alloc.free(a3, 1);
+    // a2 and a3 granules are adjacent, so this fits in their place
+    void * a5 = alloc.malloc(32);
+    alloc.free(a5, 64);
+    alloc.free(a5);
+    alloc.free(a5);
+    alloc.free(a1);
+    alloc.free(a4, 100);
+    void * a6 = alloc.malloc(4000);
+    void * a7 = alloc.malloc(4000);
+    alloc.free(a6);
+    alloc.free(a7);
+}
+
+int main() {
+    test_1();
+}
@@ -0,0 +1,46 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/buffer_chain.h>
+#include <micro-alloc/pool_memory.h>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+// same layout as struct iovec of <sys/uio.h>
+struct io_vec {
+    void * iov_base;
+    decltype(sizeof(0)) iov_len;
+};
+
+void test_1() {
+    const int size = 2048;
+    byte blocks_memory[size], segments_memory[1024];
+    pool_memory blocks{blocks_memory, size, 256};
+    pool_memory segments{segments_memory, 1024, 32};
+
+    const char message[] = "a message of unknown length, that is serialized in parts";
+    buffer_chain chain{&blocks, blocks.block_size(), &segments};
+    for (int ix = 0; ix < 10; ++ix)
+        chain.append(message, sizeof(message));
+
+    // share the second message with another chain, no data is copied
+    buffer_chain header{&blocks, blocks.block_size(), &segments};
+    chain.slice(sizeof(message), sizeof(message), header);
+
+    io_vec iovecs[8];
+    const auto count = chain.fill_iovecs(iovecs, 8);
+    // pretend writev sent the first 300 bytes
+    chain.consume(300);
+    chain.print();
+    header.print();
+    const bool ok = count == chain.iovecs_count() + 1 && header.size() == sizeof(message) &&
+                    chain.size() == 10 * sizeof(message) - 300;
+    chain.clear();
+    header.clear();
+    if (!ok || blocks.free_blocks_count() != blocks.blocks_count()) throw "buffer chain leaked blocks";
+}
+
+int main() {
+    test_1();
+}
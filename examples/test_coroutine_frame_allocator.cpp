@@ -0,0 +1,44 @@
+#define MICRO_ALLOC_DEBUG
+
+#include <micro-alloc/coroutine_frame_allocator.h>
+#include <coroutine>
+#include <iostream>
+
+using namespace micro_alloc;
+
+// a minimal lazy task, that allocates it's frames with the coroutine frame allocator
+struct task {
+    struct promise_type : coroutine_frame_promise {
+        int value = 0;
+        task get_return_object() { return task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(int v) { value = v; }
+        void unhandled_exception() {}
+    };
+
+    std::coroutine_handle<promise_type> handle;
+    explicit task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    task(task && o) noexcept : handle(o.handle) { o.handle = nullptr; }
+    ~task() { if (handle) handle.destroy(); }
+
+    int run() { handle.resume(); return handle.promise().value; }
+};
+
+task add(int a, int b) {
+    co_return a + b;
+}
+
+void test_1() {
+    int sum = 0;
+    for (int ix = 0; ix < 1000; ++ix) {
+        task t = add(ix, 1);
+        sum += t.run();
+    }
+    std::cout << "sum is " << sum << ", cached frames in bucket 0: "
+              << coroutine_frame_allocator::local().cached_count(0) << std::endl;
+}
+
+int main() {
+    test_1();
+}
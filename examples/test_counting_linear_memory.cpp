@@ -0,0 +1,32 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/counting_linear_memory.h>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+void test_1() {
+    const int size = 2048;
+    byte memory[size];
+
+    counting_linear_memory alloc{memory, size, 512};
+
+    void * a1 = alloc.malloc(200);
+    void * a2 = alloc.malloc(200);
+    // does not fit in the first chunk, moves to the next one
+    void * a3 = alloc.malloc(200);
+    alloc.free(a1);
+    // first chunk is recycled once all of it's blocks are freed
+    alloc.free(a2);
+    alloc.free(a2);
+    alloc.free(a3);
+    void * a4 = alloc.malloc(400);
+    alloc.free(a4);
+    alloc.malloc(600);
+    alloc.print(false);
+}
+
+int main() {
+    test_1();
+}
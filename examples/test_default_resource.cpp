@@ -0,0 +1,68 @@
+#include <micro-alloc/default_resource.h>
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/linear_memory.h>
+#include <micro-alloc/std_memory.h>
+#include <micro-alloc/vector.h>
+#include <thread>
+#include <vector>
+
+using namespace micro_alloc;
+using byte = unsigned char;
+
+// a deep call, that allocates without being handed a resource
+int sum_of_squares(int count) {
+    vector<int, default_allocator<int>> squares;
+    for (int ix = 0; ix < count; ++ix) squares.push_back(ix * ix);
+    int sum = 0;
+    for (int square : squares) sum += square;
+    return sum;
+}
+
+bool is_in(const void * pointer, const byte * memory, int size) {
+    return pointer >= memory && pointer < memory + size;
+}
+
+void test_1() {
+    // without a scope, the default is std_memory
+    if (get_default_resource()->type_id() != std_memory().type_id()) throw "default is not std memory";
+
+    const int size = 4096;
+    byte memory[size];
+    {
+        scoped_resource<linear_memory> request_arena{memory, size};
+        if (!is_in(default_allocator<int>().allocate(1), memory, size)) throw "did not use the scope";
+        if (sum_of_squares(10) != 285) throw "bad sum";
+
+        byte inner_memory[size];
+        linear_memory inner{inner_memory, size};
+        {
+            // scopes nest
+            scoped_resource<> statement_arena{&inner};
+            std::vector<int, default_allocator<int>> numbers{1, 2, 3};
+            if (!is_in(numbers.data(), inner_memory, size)) throw "did not use the inner scope";
+            // a polymorphic allocator captures the resource once, and keeps it after the scope ends
+            polymorphic_allocator<int> captured{get_default_resource()};
+            if (captured.resource() != &inner) throw "did not capture the inner scope";
+        }
+        if (get_default_resource() != &request_arena.resource()) throw "inner scope was not popped";
+    }
+    if (get_default_resource()->type_id() != std_memory().type_id()) throw "scope was not popped";
+}
+
+void test_2() {
+    // every thread has it's own default
+    const int size = 4096;
+    byte memory[size];
+    scoped_resource<linear_memory> arena{memory, size};
+    bool thread_used_heap = false;
+    std::thread worker([&]() {
+        thread_used_heap = get_default_resource() != &arena.resource();
+    });
+    worker.join();
+    if (!thread_used_heap) throw "the scope leaked into another thread";
+}
+
+int main() {
+    test_1();
+    test_2();
+}
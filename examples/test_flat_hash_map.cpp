@@ -0,0 +1,95 @@
+#include <micro-alloc/flat_hash_map.h>
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/std_rebind_allocator.h>
+#include <micro-alloc/linear_memory.h>
+
+using namespace micro_alloc;
+using byte = unsigned char;
+
+struct point {
+    int x, y;
+};
+
+struct counted {
+    static int alive;
+    int value;
+    explicit counted(int v) : value(v) { alive++; }
+    counted(counted && o) noexcept : value(o.value) { alive++; }
+    ~counted() { alive--; }
+};
+int counted::alive = 0;
+
+void test_1() {
+    flat_hash_map<int, int, std_rebind_allocator<>> map;
+    for (int ix = 0; ix < 1000; ++ix) map.insert(ix, ix * 2);
+    if (map.size() != 1000) throw "bad size";
+    for (int ix = 0; ix < 1000; ++ix)
+        if (!map.find(ix) || *map.find(ix) != ix * 2) throw "bad find";
+    if (map.find(1000)) throw "found a missing key";
+
+    // erase leaves tombstones or empties, later inserts reuse them
+    for (int ix = 0; ix < 1000; ix += 2) map.erase(ix);
+    if (map.size() != 500 || map.contains(10) || !map.contains(11)) throw "bad erase";
+    for (int ix = 0; ix < 1000; ix += 2) map.insert(ix, -ix);
+    if (map.size() != 1000 || *map.find(10) != -10) throw "bad reinsert";
+
+    long sum = 0, expected = 0;
+    for (int ix = 0; ix < 1000; ++ix) expected += ix % 2 ? ix * 2 : -ix;
+    map.for_each([&](const int &, int &value) { sum += value; });
+    if (sum != expected) throw "bad iteration";
+}
+
+void test_2() {
+    // entries with destructors are destroyed by erase, clear and the destructor
+    {
+        flat_hash_map<int, counted, std_rebind_allocator<>> map;
+        for (int ix = 0; ix < 100; ++ix) map.try_emplace(ix, ix);
+        map.erase(5);
+        if (counted::alive != 99) throw "erase did not destroy";
+        auto result = map.try_emplace(6, 0);
+        if (result.inserted || result.value->value != 6) throw "try_emplace replaced a value";
+    }
+    if (counted::alive != 0) throw "leaked entries";
+}
+
+void test_3() {
+    // bulk destroy by arena reset, the whole table is dropped with the arena
+    const int size = 1 << 16;
+    static byte memory[size];
+    linear_memory arena{memory, size};
+    polymorphic_allocator<> allocator{&arena};
+
+    for (int round = 0; round < 3; ++round) {
+        flat_hash_map<const void *, point, polymorphic_allocator<>> map{allocator};
+        map.reserve(1000);
+        for (int ix = 0; ix < 1000; ++ix) map.try_emplace(memory + ix, point{ix, -ix});
+        if (map.find(memory + 500)->x != 500) throw "bad arena map";
+        map.abandon();
+        arena.reset();
+    }
+}
+
+// not trivially relocatable, the destructor poisons the value
+struct poisoned {
+    int value;
+    explicit poisoned(int v) : value(v) {}
+    poisoned(const poisoned & o) : value(o.value) {}
+    ~poisoned() { value = -1; }
+};
+
+void test_4() {
+    // the value is copied from an entry of the table, that the growth relocates and frees
+    flat_hash_map<int, poisoned, std_rebind_allocator<>> map;
+    map.try_emplace(0, 7);
+    for (int ix = 1; ix < 1000; ++ix) {
+        auto result = map.try_emplace(ix, *map.find(0));
+        if (!result.inserted || result.value->value != 7) throw "try_emplace read the old table";
+    }
+}
+
+int main() {
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+}
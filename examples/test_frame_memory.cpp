@@ -0,0 +1,43 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/frame_memory.h>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+void test_1() {
+    const int size = 2048;
+    byte memory[size];
+
+    // double buffered, data of frame N lives until the end of frame N+1
+    frame_memory<> alloc{memory, size};
+
+    int * frame_0 = (int *)alloc.malloc(512);
+    frame_0[0] = 0;
+    alloc.advance_frame();
+    int * frame_1 = (int *)alloc.malloc(512);
+    frame_1[0] = frame_0[0] + 1; // frame 0 data is still alive
+    alloc.advance_frame();
+    // frame 0 arena was reset
+    int * frame_2 = (int *)alloc.malloc(1024);
+    frame_2[0] = frame_1[0] + 1;
+    alloc.malloc(512);
+}
+
+void test_2() {
+    const int size = 3000;
+    byte memory[size];
+
+    // triple buffered
+    frame_memory<3> alloc{memory, size};
+    for (int ix = 0; ix < 6; ++ix) {
+        alloc.malloc(1000);
+        alloc.advance_frame();
+    }
+}
+
+int main() {
+    test_1();
+    test_2();
+}
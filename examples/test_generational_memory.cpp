@@ -0,0 +1,35 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/generational_memory.h>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+struct entry_t {
+    int key, value;
+};
+
+void test_1() {
+    const int size = 4096;
+    byte memory[size];
+
+    generational_memory<4> cache{memory, size};
+
+    auto * hot = new(cache.malloc(sizeof(entry_t))) entry_t{1, 100};
+    auto * cold = new(cache.malloc(sizeof(entry_t))) entry_t{2, 200};
+    cache.new_epoch();
+    cache.new_epoch();
+    // keep the hot entry alive, before it's generation expires
+    hot = cache.promote(hot);
+    cache.expire_before(cache.epoch());
+    memory_resource::uptr epoch;
+    std::cout << "hot entry is alive " << cache.epoch_of(hot, epoch) << " at epoch " << epoch
+              << ", value " << hot->value << std::endl;
+    std::cout << "cold entry is alive " << cache.is_alive(cold) << std::endl;
+    cache.print(false);
+}
+
+int main() {
+    test_1();
+}
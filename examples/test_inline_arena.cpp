@@ -0,0 +1,36 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/inline_arena.h>
+#include <micro-alloc/std_memory.h>
+
+using namespace micro_alloc;
+
+void scratch_work(memory_resource * upstream) {
+    // lives on the stack, only overflows to the heap for big requests
+    inline_arena<4096> scratch{upstream};
+    void * a1 = scratch.malloc(1000);
+    void * a2 = scratch.malloc(2000);
+    void * a3 = scratch.malloc(2000);
+    scratch.free(a3);
+    scratch.free(a2);
+    scratch.free(a1);
+    scratch.print(false);
+}
+
+void test_1() {
+    std_memory heap{};
+    scratch_work(&heap);
+}
+
+void test_2() {
+    std_memory heap{};
+    inline_arena<1024, linear_memory> scratch{&heap};
+    for (int ix = 0; ix < 8; ++ix) scratch.malloc(200);
+    scratch.print(false);
+}
+
+int main() {
+    test_1();
+    test_2();
+}
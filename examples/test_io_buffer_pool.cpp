@@ -0,0 +1,53 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/io_buffer_pool.h>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+// same layout as struct iovec of <sys/uio.h>
+struct io_vec {
+    void * iov_base;
+    decltype(sizeof(0)) iov_len;
+};
+
+void test_1() {
+    const int size = 4096 * 16;
+#ifdef MICRO_ALLOC_HAS_MMAP
+    void * memory = io_buffer_pool<>::map_region(size);
+#else
+    alignas(4096) static byte memory[size];
+#endif
+
+    io_buffer_pool<> pool{memory, size};
+    pool.add_class(4096, 8);
+    pool.add_class(16384, 2);
+
+    void * a1 = pool.malloc(512);
+    void * a2 = pool.malloc(9000);
+    void * a3 = pool.malloc(4096);
+
+    // one iovec per size class, ready for io_uring_register_buffers
+    io_vec classes[4];
+    const auto classes_count = pool.fill_iovecs(classes, 4);
+    // or one iovec per buffer, buffers are then addressed by their slot
+    io_vec buffers[16];
+    const auto buffers_count = pool.fill_iovecs(buffers, 16, true);
+    const unsigned slot = pool.registration_slot(a3, true);
+    const bool ok = classes_count == 2 && buffers_count == 10 &&
+                    buffers[slot].iov_base == a3 && pool.registration_slot(a2) == 1;
+
+    pool.free(a1);
+    pool.free(a2);
+    pool.free(a3);
+    pool.print(false);
+#ifdef MICRO_ALLOC_HAS_MMAP
+    io_buffer_pool<>::unmap_region(memory, size);
+#endif
+    if (!ok) throw "registration slots do not match";
+}
+
+int main() {
+    test_1();
+}
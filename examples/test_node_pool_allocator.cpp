@@ -0,0 +1,61 @@
+#include <micro-alloc/node_pool_allocator.h>
+#include <micro-alloc/dynamic_memory.h>
+#include <micro-alloc/utils.h>
+#include <list>
+#include <map>
+#include <unordered_map>
+
+using namespace micro_alloc;
+using byte = unsigned char;
+
+void test_1() {
+    // the list rebinds to it's node type, which gets a pool of it's own
+    const int size = 1 << 16;
+    static byte memory[size];
+    static dynamic_memory upstream{memory, size};
+    node_pool_allocator<int, 2>::set_upstream(&upstream);
+
+    std::list<int, node_pool_allocator<int, 2>> numbers;
+    for (int ix = 0; ix < 1000; ++ix) numbers.push_back(ix);
+    const auto used = size - upstream.available_size();
+
+    // freed nodes are recycled, the pool does not grow
+    for (int round = 0; round < 10; ++round) {
+        for (int ix = 0; ix < 1000; ++ix) numbers.pop_front();
+        for (int ix = 0; ix < 1000; ++ix) numbers.push_back(ix);
+    }
+    if (size - upstream.available_size() != used) throw "pool grew";
+
+    // equal allocators, so a move steals the nodes
+    auto moved = std::move(numbers);
+    if (moved.size() != 1000 || moved.back() != 999) throw "bad move";
+}
+
+void test_2() {
+    // pools of a bank draw their slabs from the bank upstream
+    const int size = 1 << 16;
+    static byte memory[size];
+    static dynamic_memory upstream{memory, size};
+    node_pool_allocator<int, 1>::set_upstream(&upstream);
+
+    std::map<int, int, std::less<int>, node_pool_allocator<std::pair<const int, int>, 1>> map;
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+            node_pool_allocator<std::pair<const int, int>, 1>> hash_map;
+    for (int ix = 0; ix < 100; ++ix) {
+        map[ix] = ix;
+        hash_map[ix] = ix;
+    }
+    if (upstream.available_size() == size || map[50] != 50 || hash_map[50] != 50) throw "bad upstream";
+
+    // arrays go to the upstream, and are told apart from nodes without a count
+    node_pool_allocator<int, 1> allocator;
+    auto * array = new_array<int>(100, allocator, 7);
+    auto * object = new_object<int>(allocator, 7);
+    delete_array(array, allocator);
+    delete_object(object, allocator);
+}
+
+int main() {
+    test_1();
+    test_2();
+}
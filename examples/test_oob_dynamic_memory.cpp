@@ -0,0 +1,48 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/oob_dynamic_memory.h>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+void test_1() {
+    // manage offsets of a 1MB file, there is no memory at all
+    const int metadata_size = oob_dynamic_memory::metadata_size_for(8);
+    byte metadata[metadata_size];
+
+    oob_dynamic_memory alloc{nullptr, 1<<20, metadata, metadata_size, 4096};
+
+    auto o1 = alloc.malloc_offset(5000);
+    auto o2 = alloc.malloc_offset(4096);
+    auto o3 = alloc.malloc_offset(100);
+    alloc.free_offset(o2);
+    alloc.free_offset(o2);
+    alloc.free_offset(o1);
+    alloc.free_offset(o3);
+}
+
+void test_2() {
+    // manage memory, that is never written to
+    const int size = 5000;
+    byte memory[size];
+    const int metadata_size = oob_dynamic_memory::metadata_size_for(4);
+    byte metadata[metadata_size];
+
+    oob_dynamic_memory alloc{memory, size, metadata, metadata_size};
+
+    void * a1 = alloc.malloc(200);
+    void * a2 = alloc.malloc(200);
+    void * a3 = alloc.malloc(200);
+    // out of nodes, the last free block is handed whole
+    void * a4 = alloc.malloc(200);
+    alloc.free(a3);
+    alloc.free(a1);
+    alloc.free(a2);
+    alloc.free(a4);
+}
+
+int main() {
+    test_1();
+    test_2();
+}
@@ -0,0 +1,42 @@
+#include <micro-alloc/parallel_utils.h>
+#include <micro-alloc/std_rebind_allocator.h>
+#include <atomic>
+
+using namespace micro_alloc;
+
+static std::atomic<long> alive{0};
+
+struct particle {
+    float x, y, z;
+    explicit particle(float value = 0) : x(value), y(value), z(value) { alive++; }
+    ~particle() { alive--; }
+};
+
+void test_trivial() {
+    const uintptr_type count = 8 * 1024 * 1024;
+    std_rebind_allocator<> allocator;
+    thread_executor executor{4};
+
+    // value-init is a memset per chunk, every chunk is first touched by it's own thread
+    auto * zeros = parallel_new_array<int>(count, allocator, executor);
+    auto * sevens = parallel_new_array<int>(count, allocator, executor, 7);
+    const bool ok = zeros[0] == 0 && zeros[count - 1] == 0 && sevens[count / 2] == 7 && sevens[count - 1] == 7;
+    parallel_delete_array(zeros, allocator, executor);
+    delete_array(sevens, allocator);
+    if (!ok) throw "bad parallel array";
+}
+
+void test_objects() {
+    const uintptr_type count = 1024 * 1024;
+    std_rebind_allocator<> allocator;
+
+    auto * particles = parallel_new_array<particle>(count, allocator, thread_executor{}, 1.5f);
+    const bool ok = alive == long(count) && particles[count - 1].z == 1.5f;
+    parallel_delete_array(particles, allocator, thread_executor{});
+    if (!ok || alive != 0) throw "bad parallel construction";
+}
+
+int main() {
+    test_trivial();
+    test_objects();
+}
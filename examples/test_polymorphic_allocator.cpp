@@ -21,7 +21,7 @@ void test_1() {
     const int size = 5000;
     byte memory[size];
 
-    dynamic_memory<> mem_resource{memory, size};
+    dynamic_memory mem_resource{memory, size};
     polymorphic_allocator<dummy_t> allocator(&mem_resource);
 
     // allocate raw memory that can for 5 dummies
@@ -0,0 +1,51 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/refcounted_memory.h>
+#include <micro-alloc/pool_memory.h>
+#include <micro-alloc/dynamic_memory.h>
+#include <thread>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+void test_pool() {
+    const int size = 2048;
+    byte memory[size];
+    // every packet takes the header on top of it's 240 bytes
+    pool_memory pool{memory, size, 256};
+    refcounted_memory<> packets{&pool};
+
+    void * packet = packets.malloc(240);
+    // two more consumers share the packet
+    packets.retain(packet);
+    packets.retain(packet);
+    packets.release(packet);
+    packets.free(packet);
+    const bool ok = packets.use_count(packet) == 1 && pool.free_blocks_count() == pool.blocks_count() - 1;
+    packets.release(packet);
+    if (!ok || pool.free_blocks_count() != pool.blocks_count()) throw "refcount mismatch";
+}
+
+void test_dynamic_atomic() {
+    const int size = 5000;
+    byte memory[size];
+    dynamic_memory dynamic{memory, size};
+    refcounted_memory<true> packets{&dynamic};
+
+    void * packet = packets.malloc(300);
+    const int consumers = 4;
+    std::thread threads[consumers];
+    for (int ix = 0; ix < consumers; ++ix) packets.retain(packet);
+    for (auto & thread : threads)
+        thread = std::thread([&packets, packet]() { packets.release(packet); });
+    for (auto & thread : threads) thread.join();
+    const bool ok = packets.use_count(packet) == 1;
+    packets.release(packet);
+    if (!ok) throw "refcount mismatch";
+}
+
+int main() {
+    test_pool();
+    test_dynamic_atomic();
+}
@@ -0,0 +1,49 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/region_memory.h>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+void test_1() {
+    const int size = 4096;
+    byte memory[size];
+
+    region_memory server{memory, size, 512};
+    server.malloc(100);
+    {
+        region_memory request{server};
+        request.malloc(400);
+        request.malloc(400);
+        {
+            region_memory transaction{request};
+            region_memory statement{transaction};
+            statement.malloc(300);
+            transaction.malloc(200);
+            // statement dies with it's scope, it's chunk is back at the root
+        }
+        request.print(false);
+    }
+    // the request was destroyed, it's chunks are back at the root
+    server.print(false);
+}
+
+void test_2() {
+    const int size = 4096;
+    byte memory[size];
+
+    region_memory root{memory, size, 1024};
+    auto * request = new region_memory(root);
+    region_memory statement{*request};
+    statement.malloc(100);
+    // destroying a parent releases the whole subtree
+    delete request;
+    statement.malloc(100);
+    root.print(false);
+}
+
+int main() {
+    test_1();
+    test_2();
+}
@@ -0,0 +1,84 @@
+//#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/ring_memory.h>
+#include <iostream>
+#include <thread>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+void test_1() {
+    const int size = 1024;
+    byte memory[size];
+
+    ring_memory alloc{memory, size};
+
+    void * a1 = alloc.malloc(400);
+    void * a2 = alloc.malloc(200);
+    void * a3 = alloc.malloc(200);
+    // out of order free is tolerated, space is reclaimed after a1 is freed
+    alloc.free(a2);
+    alloc.free(a1);
+    // does not fit at the end, wraps around with a skip marker
+    void * a4 = alloc.malloc(300);
+    std::cout << "wrapped around: " << (a4 < a3 ? "yes" : "no") << std::endl;
+    alloc.free(a3);
+    alloc.free(a4);
+    std::cout << "available after all frees " << alloc.available_size() << std::endl;
+}
+
+void test_2() {
+    // lock-free single producer/single consumer messages
+    const int size = 4096;
+    byte memory[size];
+    const int messages = 100000;
+
+    ring_memory ring{memory, size, sizeof(void *), true};
+
+    std::thread producer([&ring]() {
+        for (int ix = 0; ix < messages; ++ix) {
+            int * message;
+            while (!(message = (int *)ring.reserve((ix % 16 + 1) * sizeof(int))))
+                std::this_thread::yield();
+            for (int jx = 0; jx < ix % 16 + 1; ++jx) message[jx] = ix;
+            ring.publish();
+        }
+    });
+
+    long long sum = 0, expected = 0;
+    for (int ix = 0; ix < messages; ++ix) {
+        expected += (long long)ix * (ix % 16 + 1);
+        memory_resource::uptr message_size;
+        int * message;
+        while (!(message = (int *)ring.front(&message_size)))
+            std::this_thread::yield();
+        for (unsigned jx = 0; jx < message_size / sizeof(int) && jx < unsigned(ix % 16 + 1); ++jx)
+            sum += message[jx];
+        ring.pop();
+    }
+    producer.join();
+    std::cout << "spsc sum " << sum << ", expected " << expected << std::endl;
+}
+
+void test_3() {
+    // an spsc ring is never rewound when it is empty, so it wraps from an empty state, and
+    // the tail has to move past the skip marker, when the block after it is freed
+    const int size = 1024;
+    byte memory[size];
+
+    ring_memory ring{memory, size, sizeof(void *), true};
+    ring.free(ring.malloc(600));
+    for (int ix = 0; ix < 10; ++ix) {
+        void * block = ring.malloc(500);
+        if (!block) throw "empty spsc ring did not wrap";
+        ring.free(block);
+    }
+    std::cout << "spsc wrap after empty, available " << ring.available_size() << std::endl;
+}
+
+int main() {
+    test_1();
+    test_2();
+    test_3();
+}
@@ -0,0 +1,60 @@
+#define MICRO_ALLOC_DEBUG
+//#define MICRO_ALLOC_ENABLE_THROW
+
+#include <micro-alloc/shared_ptr.h>
+#include <micro-alloc/std_rebind_allocator.h>
+#include <micro-alloc/static_linear_allocator.h>
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/dynamic_memory.h>
+#include <iostream>
+
+using namespace micro_alloc;
+using byte= unsigned char;
+
+struct packet {
+    int id;
+    long payload;
+    packet(int id, long payload) : id(id), payload(payload) {}
+    ~packet() { std::cout << "- packet #" << id << " destroyed\n"; }
+};
+
+// stateless allocators cost zero bytes in the allocation
+static_assert(sizeof(detail::shared_block<long, std_rebind_allocator<>, false>) == 3 * sizeof(void *),
+              "stateless allocator should be an empty base");
+
+void test_std() {
+    auto p1 = allocate_shared<packet>(std_rebind_allocator<>(), 1, 100L);
+    auto p2 = p1;
+    shared_ptr<packet> p3;
+    p3 = p2;
+    std::cout << "- use count " << p1.use_count() << "\n";
+    p1.reset();
+    p2.reset();
+    if (p3.use_count() != 1 || p3->payload != 100) throw "bad use count";
+}
+
+void test_static_linear() {
+    static_linear_allocator<byte, 1024, 1> allocator;
+    auto p1 = allocate_shared<packet>(allocator, 2, 200L);
+    auto p2 = p1;
+}
+
+void test_polymorphic_atomic() {
+    const int size = 5000;
+    byte memory[size];
+    dynamic_memory dynamic{memory, size};
+    polymorphic_allocator<> allocator{&dynamic};
+
+    auto p1 = allocate_shared<packet, true>(allocator, 3, 300L);
+    shared_ptr<packet, true> p2{p1};
+    const auto available = dynamic.available_size();
+    p1.reset();
+    p2.reset();
+    if (dynamic.available_size() <= available) throw "block was not returned to the resource";
+}
+
+int main() {
+    test_std();
+    test_static_linear();
+    test_polymorphic_atomic();
+}
@@ -0,0 +1,57 @@
+#include <micro-alloc/string_interner.h>
+#include <micro-alloc/std_memory.h>
+#include <micro-alloc/dynamic_memory.h>
+
+using namespace micro_alloc;
+using byte = unsigned char;
+
+void test_1() {
+    std_memory upstream;
+    string_interner labels{&upstream, 256};
+
+    const auto get = labels.intern("GET");
+    const auto post = labels.intern("POST");
+    // the same string is stored once, and keeps it's id
+    if (labels.intern(string_ref("GET /index", 3)) != get) throw "duplicated a string";
+    if (get == post || labels.size() != 2) throw "bad ids";
+    if (labels.str(post) != "POST" || labels.str(post).data()[4] != '\0') throw "bad view";
+    if (labels.find("PUT") != string_interner::invalid_id) throw "found a missing string";
+
+    // many strings span many chunks, views stay valid
+    char name[16] = "label-";
+    for (int ix = 0; ix < 1000; ++ix) {
+        name[6] = char('a' + ix % 26); name[7] = char('a' + ix / 26 % 26); name[8] = char('a' + ix / 676);
+        labels.intern(string_ref(name, 9));
+    }
+    if (labels.size() != 1002 || labels.str(get) != "GET") throw "bad chained arena";
+
+    // a string larger than a chunk gets a chunk of it's own
+    char huge[1000];
+    for (char & c : huge) c = 'x';
+    const auto huge_id = labels.intern(string_ref(huge, sizeof huge));
+    if (labels.str(huge_id).size() != sizeof huge) throw "bad huge string";
+
+    labels.reset();
+    if (labels.size() != 0 || labels.find("GET") != string_interner::invalid_id) throw "bad reset";
+    if (labels.intern("GET") != 0) throw "ids do not restart";
+}
+
+void test_2() {
+    // out of memory is reported with invalid_id
+    const int size = 2000;
+    byte memory[size];
+    dynamic_memory upstream{memory, size};
+    string_interner labels{&upstream, 128};
+    char name[8] = "n";
+    string_interner::id_type last = 0;
+    for (int ix = 0; ix < 10000 && last != string_interner::invalid_id; ++ix) {
+        name[1] = char('a' + ix % 26); name[2] = char('a' + ix / 26 % 26); name[3] = char('a' + ix / 676 % 26);
+        last = labels.intern(string_ref(name, 4));
+    }
+    if (last != string_interner::invalid_id) throw "upstream did not run out";
+}
+
+int main() {
+    test_1();
+    test_2();
+}
@@ -42,7 +42,44 @@ void test_2() {
     micro_alloc::delete_array(array, allocator);
 }
 
+void test_3() {
+    const int size = 5000;
+    byte memory[size];
+
+    dynamic_memory mem_resource{memory, size};
+    polymorphic_allocator<int> allocator(&mem_resource);
+
+    // trivial types have no header, value-init is a memset and copy-init is a fill
+    const auto available = mem_resource.available_size();
+    auto * zeros = micro_alloc::new_array<int>(100, allocator);
+    auto * sevens = micro_alloc::new_array<int>(100, allocator, 7);
+    const bool ok = zeros[99] == 0 && sevens[0] == 7 && sevens[99] == 7;
+    micro_alloc::delete_array(zeros, allocator);
+    micro_alloc::delete_array(sevens, allocator);
+    if (!ok || mem_resource.available_size() != available) throw "bad trivial array";
+}
+
+struct alignas(32) wide_t {
+    float lanes[8];
+    ~wide_t() {}
+};
+
+void test_4() {
+    const int size = 5000;
+    byte memory[size];
+
+    // the header of an over-aligned type is a multiple of it's alignment
+    dynamic_memory mem_resource{memory, size, 32};
+    polymorphic_allocator<wide_t> allocator(&mem_resource);
+    auto * array = micro_alloc::new_array<wide_t>(4, allocator);
+    const bool ok = reinterpret_cast<uintptr_type>(array) % 32 == 0;
+    micro_alloc::delete_array(array, allocator);
+    if (!ok) throw "array is not aligned";
+}
+
 int main() {
     test_1();
+    test_3();
+    test_4();
 //    test_2();
 }
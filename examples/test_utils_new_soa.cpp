@@ -0,0 +1,54 @@
+#define MICRO_ALLOC_DEBUG
+
+#include <micro-alloc/dynamic_memory.h>
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/utils.h>
+
+using namespace micro_alloc;
+using byte = unsigned char;
+
+void test_1() {
+    const int size = 10000;
+    byte memory[size];
+
+    dynamic_memory mem_resource{memory, size};
+    polymorphic_allocator<> allocator(&mem_resource);
+
+    // three columns in one allocation, every column is aligned to a cache line
+    const auto available = mem_resource.available_size();
+    auto particles = new_soa<float, float, char>(100, allocator);
+    auto xs = particles.get<0>();
+    auto ys = particles.get<1>();
+    auto flags = particles.get<2>();
+    for (uintptr_type ix = 0; ix < particles.size(); ++ix) {
+        xs[ix] = float(ix);
+        ys[ix] = xs[ix] * 2;
+    }
+    const bool ok = reinterpret_cast<uintptr_type>(xs.data()) % 64 == 0 &&
+                    reinterpret_cast<uintptr_type>(ys.data()) % 64 == 0 &&
+                    reinterpret_cast<uintptr_type>(flags.data()) % 64 == 0 &&
+                    ys[99] == 198 && flags[50] == 0;
+    delete_soa(particles, allocator);
+    if (!ok || particles || mem_resource.available_size() != available) throw "bad struct of arrays";
+}
+
+struct alignas(32) wide { float lanes[8]; };
+
+void test_2() {
+    const int size = 10000;
+    byte memory[size];
+
+    dynamic_memory mem_resource{memory, size};
+    polymorphic_allocator<> allocator(&mem_resource);
+
+    // a column type, that is aligned more than the requested alignment, is still aligned
+    auto columns = new_soa<char, wide>(10, allocator, 8);
+    const bool ok = reinterpret_cast<uintptr_type>(columns.get<1>().data()) % alignof(wide) == 0;
+    delete_soa(columns, allocator);
+    if (!ok) throw "misaligned column";
+}
+
+int main() {
+    test_1();
+    test_2();
+}
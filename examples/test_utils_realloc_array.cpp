@@ -0,0 +1,60 @@
+#define MICRO_ALLOC_DEBUG
+
+#include <micro-alloc/dynamic_memory.h>
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/utils.h>
+
+using namespace micro_alloc;
+using byte = unsigned char;
+
+// owns heap memory, but never points into itself, so it can be moved with a memcpy
+struct heap_string {
+    char * chars;
+    explicit heap_string(char c = 'a') : chars(new char[2]{c, 0}) {}
+    heap_string(heap_string && other) noexcept : chars(other.chars) { other.chars = nullptr; }
+    ~heap_string() { delete[] chars; }
+};
+template<> struct micro_alloc::traits::is_trivially_relocatable<heap_string> : micro_alloc::traits::true_type {};
+
+static int alive = 0;
+struct tracked {
+    int value;
+    explicit tracked(int value = 0) : value(value) { alive++; }
+    tracked(tracked && other) noexcept : value(other.value) { alive++; }
+    ~tracked() { alive--; }
+};
+
+void test_1() {
+    const int size = 5000;
+    byte memory[size];
+    dynamic_memory mem_resource{memory, size};
+    polymorphic_allocator<> allocator(&mem_resource);
+
+    // grows with a single memcpy, no moves and no destructors
+    auto * strings = new_array<heap_string>(4, allocator, 'x');
+    strings = realloc_array(strings, 4, 10, allocator, 'y');
+    const bool ok = strings[3].chars[0] == 'x' && strings[9].chars[0] == 'y';
+    delete_array(strings, allocator);
+    if (!ok) throw "bad relocation";
+}
+
+void test_2() {
+    const int size = 5000;
+    byte memory[size];
+    dynamic_memory mem_resource{memory, size};
+    polymorphic_allocator<> allocator(&mem_resource);
+
+    // move constructs and destructs every object
+    auto * array = new_array<tracked>(8, allocator, 5);
+    array = realloc_array(array, 8, 3, allocator);
+    const bool ok = alive == 3 && array[2].value == 5;
+    array = realloc_array(array, 3, 6, allocator, 9);
+    const bool ok2 = alive == 6 && array[5].value == 9;
+    delete_array(array, allocator);
+    if (!ok || !ok2 || alive != 0) throw "bad relocation";
+}
+
+int main() {
+    test_1();
+    test_2();
+}
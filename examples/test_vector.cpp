@@ -0,0 +1,92 @@
+#define MICRO_ALLOC_DEBUG
+
+#include <micro-alloc/vector.h>
+#include <micro-alloc/polymorphic_allocator.h>
+#include <micro-alloc/std_rebind_allocator.h>
+#include <micro-alloc/linear_memory.h>
+#include <micro-alloc/stack_memory.h>
+#include <micro-alloc/dynamic_memory.h>
+
+using namespace micro_alloc;
+using byte = unsigned char;
+
+// grows a vector and counts how many times the buffer moved
+template<class Memory>
+int count_moves(Memory & memory) {
+    polymorphic_allocator<> allocator{&memory};
+    vector<long, polymorphic_allocator<>> numbers{allocator};
+    numbers.push_back(0);
+    const long * data = numbers.data();
+    int moves = 0;
+    for (long ix = 1; ix < 100; ++ix) {
+        numbers.push_back(ix);
+        if (numbers.data() != data) moves++;
+        data = numbers.data();
+    }
+    if (numbers[99] != 99) throw "bad vector";
+    return moves;
+}
+
+void test_in_place() {
+    const int size = 5000;
+    byte memory_1[size], memory_2[size], memory_3[size];
+    linear_memory linear{memory_1, size};
+    stack_memory stack{memory_2, size};
+    dynamic_memory dynamic{memory_3, size};
+
+    // the buffer is the top block, or has a free right neighbour, so it always grows in place
+    if (count_moves(linear) != 0) throw "linear vector moved";
+    if (count_moves(stack) != 0) throw "stack vector moved";
+    if (count_moves(dynamic) != 0) throw "dynamic vector moved";
+}
+
+void test_relocate() {
+    // without expand the vector relocates
+    vector<int, std_rebind_allocator<>> numbers;
+    for (int ix = 0; ix < 1000; ++ix) numbers.push_back(ix);
+    numbers.resize(2000, 7);
+    auto copy = numbers;
+    if (copy.size() != 2000 || copy[999] != 999 || copy[1999] != 7) throw "bad vector";
+}
+
+// not trivially relocatable, the destructor poisons the value
+struct poisoned {
+    int value;
+    explicit poisoned(int value) : value(value) {}
+    poisoned(const poisoned & other) : value(other.value) {}
+    ~poisoned() { value = -1; }
+};
+
+void test_self_aliasing() {
+    // the argument points into the buffer, that the growth relocates and frees
+    vector<poisoned, std_rebind_allocator<>> values;
+    values.emplace_back(7);
+    for (int ix = 0; ix < 100; ++ix) {
+        const bool full = values.size() == values.capacity();
+        values.push_back(values[0]);
+        if (full && values.back().value != 7) throw "push_back read the old buffer";
+    }
+    values.resize(1000, values[0]);
+    if (values[999].value != 7) throw "resize read the old buffer";
+}
+
+void test_realloc_array() {
+    const int size = 5000;
+    byte memory[size];
+    dynamic_memory dynamic{memory, size};
+    polymorphic_allocator<> allocator{&dynamic};
+
+    // realloc_array resizes in place through the resource as well
+    auto * array = new_array<int>(10, allocator, 1);
+    auto * grown = realloc_array(array, 10, 100, allocator, 2);
+    const bool ok = grown == array && grown[9] == 1 && grown[99] == 2;
+    delete_array(grown, allocator);
+    if (!ok) throw "realloc_array moved";
+}
+
+int main() {
+    test_in_place();
+    test_relocate();
+    test_self_aliasing();
+    test_realloc_array();
+}
@@ -0,0 +1,162 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+#include "utils.h"
+
+namespace micro_alloc {
+
+    /**
+     * Allocator aware unique pointer:
+     *
+     * Owns an object, that was created with new_object(), and deletes it with delete_object()
+     * and the same allocator. Stateless allocators (std_rebind_allocator, static_linear_allocator)
+     * are stored as an empty base, so the pointer is the size of a raw pointer, and a
+     * polymorphic_allocator adds only it's resource pointer.
+     *
+     * @tparam T object type, or U[] for arrays of new_array()
+     * @tparam Alloc allocator type
+     */
+    template<class T, class Alloc>
+    class alloc_unique : private detail::allocator_holder<Alloc> {
+    private:
+        using holder = detail::allocator_holder<Alloc>;
+        T *_pointer;
+
+    public:
+        using element_type = T;
+        using allocator_type = Alloc;
+
+        alloc_unique() noexcept : holder(), _pointer(nullptr) {}
+        explicit alloc_unique(const Alloc &alloc, T *pointer = nullptr) noexcept :
+                holder(alloc), _pointer(pointer) {}
+        alloc_unique(const alloc_unique &) = delete;
+        alloc_unique &operator=(const alloc_unique &) = delete;
+        alloc_unique(alloc_unique &&other) noexcept : holder(other.get_allocator()), _pointer(other.release()) {}
+        alloc_unique &operator=(alloc_unique &&other) noexcept {
+            if (this == &other) return *this;
+            reset();
+            holder::assign(other.get_allocator());
+            _pointer = other.release();
+            return *this;
+        }
+        ~alloc_unique() { reset(); }
+
+        /**
+         * give up ownership without deleting
+         */
+        T *release() noexcept {
+            T *pointer = _pointer;
+            _pointer = nullptr;
+            return pointer;
+        }
+
+        /**
+         * delete the owned object, and take ownership of {pointer}
+         */
+        void reset(T *pointer = nullptr) {
+            T *old = _pointer;
+            _pointer = pointer;
+            if (old) delete_object(old, get_allocator());
+        }
+
+        const Alloc &get_allocator() const noexcept { return holder::allocator(); }
+        T *get() const noexcept { return _pointer; }
+        T &operator*() const noexcept { return *_pointer; }
+        T *operator->() const noexcept { return _pointer; }
+        explicit operator bool() const noexcept { return _pointer != nullptr; }
+    };
+
+    /**
+     * Allocator aware unique pointer of an array, that was created with new_array(), and is
+     * deleted with delete_array()
+     */
+    template<class T, class Alloc>
+    class alloc_unique<T[], Alloc> : private detail::allocator_holder<Alloc> {
+    private:
+        using holder = detail::allocator_holder<Alloc>;
+        T *_pointer;
+
+    public:
+        using element_type = T;
+        using allocator_type = Alloc;
+
+        alloc_unique() noexcept : holder(), _pointer(nullptr) {}
+        explicit alloc_unique(const Alloc &alloc, T *pointer = nullptr) noexcept :
+                holder(alloc), _pointer(pointer) {}
+        alloc_unique(const alloc_unique &) = delete;
+        alloc_unique &operator=(const alloc_unique &) = delete;
+        alloc_unique(alloc_unique &&other) noexcept : holder(other.get_allocator()), _pointer(other.release()) {}
+        alloc_unique &operator=(alloc_unique &&other) noexcept {
+            if (this == &other) return *this;
+            reset();
+            holder::assign(other.get_allocator());
+            _pointer = other.release();
+            return *this;
+        }
+        ~alloc_unique() { reset(); }
+
+        T *release() noexcept {
+            T *pointer = _pointer;
+            _pointer = nullptr;
+            return pointer;
+        }
+
+        void reset(T *pointer = nullptr) {
+            T *old = _pointer;
+            _pointer = pointer;
+            if (old) delete_array(old, get_allocator());
+        }
+
+        const Alloc &get_allocator() const noexcept { return holder::allocator(); }
+        T *get() const noexcept { return _pointer; }
+        T &operator[](uintptr_type index) const noexcept { return _pointer[index]; }
+        explicit operator bool() const noexcept { return _pointer != nullptr; }
+    };
+
+    namespace detail {
+        template<class T>
+        struct unique_maker {
+            template<class Alloc, class... Args>
+            static alloc_unique<T, Alloc> make(const Alloc &alloc, Args &&... args) {
+                return alloc_unique<T, Alloc>(alloc, new_object<T>(alloc, micro_alloc::traits::forward<Args>(args)...));
+            }
+        };
+
+        template<class T>
+        struct unique_maker<T[]> {
+            template<class Alloc, class... Args>
+            static alloc_unique<T[], Alloc> make(const Alloc &alloc, const unsigned count, Args &&... args) {
+                return alloc_unique<T[], Alloc>(alloc, new_array<T>(count, alloc,
+                                                                    micro_alloc::traits::forward<Args>(args)...));
+            }
+        };
+    }
+
+    /**
+     * Allocate and Construct an object or an array, owned by an alloc_unique
+     *
+     * - make_alloc_unique<T>(allocator, args...) uses new_object()
+     * - make_alloc_unique<T[]>(allocator, count, args...) uses new_array()
+     *
+     * @tparam T object type, or U[] for arrays
+     * @tparam Alloc allocator type
+     * @tparam Args constructor arg types
+     * @param alloc allocator to use, it is copied into the pointer
+     * @param args count for arrays, followed by constructor arguments
+     */
+    template<class T, class Alloc, class... Args>
+    auto make_alloc_unique(const Alloc &alloc, Args &&... args) ->
+            decltype(detail::unique_maker<T>::make(alloc, micro_alloc::traits::forward<Args>(args)...)) {
+        return detail::unique_maker<T>::make(alloc, micro_alloc::traits::forward<Args>(args)...);
+    }
+}
@@ -0,0 +1,305 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+#include "traits.h"
+// <atomic> and <new> are freestanding headers, they do not require the standard library
+#include <atomic>
+#include <new>
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    class arena_buffer_cache;
+
+    /**
+     * A buffer, that was handed by an arena_buffer_cache. It is move only, and returns the
+     * buffer to the cache upon destruction. Moving it is O(1), so a buffer can follow it's
+     * owner across threads.
+     */
+    class arena_buffer {
+    private:
+        using uptr = memory_resource::uintptr_type;
+        friend class arena_buffer_cache;
+
+        void *_data;
+        uptr _size;
+        unsigned _size_class;
+        arena_buffer_cache *_cache;
+
+        arena_buffer(void *data, uptr size, unsigned size_class, arena_buffer_cache *cache) :
+                _data(data), _size(size), _size_class(size_class), _cache(cache) {}
+
+    public:
+        arena_buffer() : arena_buffer(nullptr, 0, 0, nullptr) {}
+        arena_buffer(const arena_buffer &) = delete;
+        arena_buffer &operator=(const arena_buffer &) = delete;
+        arena_buffer(arena_buffer &&other) noexcept :
+                arena_buffer(other._data, other._size, other._size_class, other._cache) {
+            other._data = nullptr;
+            other._size = 0;
+        }
+        arena_buffer &operator=(arena_buffer &&other) noexcept {
+            if (this == &other) return *this;
+            reset();
+            _data = other._data; _size = other._size;
+            _size_class = other._size_class; _cache = other._cache;
+            other._data = nullptr;
+            other._size = 0;
+            return *this;
+        }
+        ~arena_buffer() { reset(); }
+
+        void *data() const { return _data; }
+        uptr size() const { return _size; }
+        explicit operator bool() const { return _data != nullptr; }
+
+        /**
+         * return the buffer to it's cache
+         */
+        inline void reset();
+    };
+
+    /**
+     * Arena Buffer Cache:
+     *
+     * Recycles the big buffers, that arenas (linear, stack, dynamic memory etc..) are built on.
+     * Buffers are grouped by power of 2 size classes, they are taken from an upstream memory
+     * resource once, pre-faulted by touching every page, and then handed back and forth between
+     * arenas, which turns arena creation into a couple of pointer operations.
+     *
+     * - acquire() and release are O(1)
+     * - Thread safe, the free lists are guarded by a spin lock, that is held for a few
+     *   instructions only. Calls to the upstream resource are made under the lock as well,
+     *   so the upstream does not have to be thread safe.
+     *
+     * Notes:
+     * - Size class k holds buffers of (min_size << k) bytes
+     * - Requests larger than the largest class are served by the upstream, and are not cached
+     * - Each class caches at most {max_cached_per_class} buffers, the rest go back upstream
+     * - The cache must outlive all of it's buffers
+     */
+    class arena_buffer_cache {
+    public:
+        using uptr = memory_resource::uintptr_type;
+        static constexpr unsigned max_size_classes = 32;
+
+    private:
+        struct node_t { node_t *next; };
+
+        memory_resource *_upstream;
+        uptr _min_size;
+        unsigned _size_classes;
+        uptr _max_cached_per_class;
+        uptr _page_size;
+        node_t *_free_lists[max_size_classes];
+        uptr _cached_counts[max_size_classes];
+        std::atomic_flag _lock = ATOMIC_FLAG_INIT;
+
+        void lock() { while (_lock.test_and_set(std::memory_order_acquire)); }
+        void unlock() { _lock.clear(std::memory_order_release); }
+
+        unsigned size_class_of(uptr size_bytes) const {
+            unsigned size_class = 0;
+            while (size_class < _size_classes && class_size(size_class) < size_bytes) size_class += 1;
+            return size_class;
+        }
+
+        void prefault(void *data, uptr size_bytes) const {
+            volatile auto *bytes = static_cast<volatile unsigned char *>(data);
+            for (uptr ix = 0; ix < size_bytes; ix += _page_size) bytes[ix] = 0;
+        }
+
+        friend class arena_buffer;
+        void release(void *data, uptr size_bytes, unsigned size_class) {
+            lock();
+            if (size_class < _size_classes && _cached_counts[size_class] < _max_cached_per_class) {
+                auto *node = static_cast<node_t *>(data);
+                node->next = _free_lists[size_class];
+                _free_lists[size_class] = node;
+                _cached_counts[size_class] += 1;
+            } else _upstream->free(data);
+            unlock();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nRELEASE:: arena buffer cache\n- took back a buffer of " << size_bytes << " bytes\n";
+#endif
+        }
+
+    public:
+        arena_buffer_cache() = delete;
+        arena_buffer_cache(const arena_buffer_cache &) = delete;
+        arena_buffer_cache &operator=(const arena_buffer_cache &) = delete;
+
+        /**
+         * ctor
+         *
+         * @param upstream memory resource for the buffers, usually std_memory or a memory, that maps pages
+         * @param min_size size of the smallest class, a power of 2
+         * @param size_classes number of size classes, <= max_size_classes
+         * @param max_cached_per_class max number of idle buffers, that are kept per class
+         * @param page_size page size, used for pre-faulting
+         */
+        explicit arena_buffer_cache(memory_resource *upstream, uptr min_size = 4096,
+                                    unsigned size_classes = 12, uptr max_cached_per_class = 8,
+                                    uptr page_size = 4096) :
+                _upstream(upstream), _min_size(min_size),
+                _size_classes(size_classes < max_size_classes ? size_classes : max_size_classes),
+                _max_cached_per_class(max_cached_per_class), _page_size(page_size ? page_size : 4096) {
+            for (unsigned ix = 0; ix < max_size_classes; ++ix) {
+                _free_lists[ix] = nullptr;
+                _cached_counts[ix] = 0;
+            }
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: arena buffer cache\n";
+            std::cout << "* " << _size_classes << " size classes of [" << class_size(0) << "-"
+                      << class_size(_size_classes - 1) << "] bytes" << std::endl;
+#endif
+        }
+
+        ~arena_buffer_cache() { trim(); }
+
+        uptr class_size(unsigned size_class) const { return _min_size << size_class; }
+        uptr cached_count(unsigned size_class) const { return _cached_counts[size_class]; }
+
+        /**
+         * get a buffer of at least {size_bytes} bytes
+         * @return the buffer, that evaluates to false upon failure
+         */
+        arena_buffer acquire(uptr size_bytes) {
+            const unsigned size_class = size_class_of(size_bytes);
+            const bool is_cached_class = size_class < _size_classes;
+            const uptr buffer_size = is_cached_class ? class_size(size_class) : size_bytes;
+            void *data = nullptr;
+            lock();
+            if (is_cached_class && _free_lists[size_class]) {
+                node_t *node = _free_lists[size_class];
+                _free_lists[size_class] = node->next;
+                _cached_counts[size_class] -= 1;
+                data = node;
+                unlock();
+            } else {
+                data = _upstream->malloc(buffer_size);
+                unlock();
+                if (data) prefault(data, buffer_size);
+            }
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nACQUIRE:: arena buffer cache\n- handed a buffer of " << buffer_size
+                      << " bytes @" << data << "\n";
+#endif
+            if (!data) return arena_buffer();
+            return arena_buffer(data, buffer_size, size_class, this);
+        }
+
+        /**
+         * warm up a size class with {count} pre-faulted buffers
+         */
+        void reserve(uptr size_bytes, uptr count) {
+            const unsigned size_class = size_class_of(size_bytes);
+            if (size_class >= _size_classes) return;
+            for (uptr ix = 0; ix < count; ++ix) {
+                void *data;
+                lock();
+                data = _upstream->malloc(class_size(size_class));
+                unlock();
+                if (!data) return;
+                prefault(data, class_size(size_class));
+                release(data, class_size(size_class), size_class);
+            }
+        }
+
+        /**
+         * return all idle buffers to the upstream resource
+         */
+        void trim() {
+            lock();
+            for (unsigned ix = 0; ix < _size_classes; ++ix) {
+                while (_free_lists[ix]) {
+                    node_t *node = _free_lists[ix];
+                    _free_lists[ix] = node->next;
+                    _upstream->free(node);
+                }
+                _cached_counts[ix] = 0;
+            }
+            unlock();
+        }
+    };
+
+    void arena_buffer::reset() {
+        if (_data && _cache) _cache->release(_data, _size, _size_class);
+        _data = nullptr;
+        _size = 0;
+    }
+
+    /**
+     * An arena, that is built on a buffer of an arena_buffer_cache, and gives it back upon
+     * destruction. It is move only, moving is O(1), so a request arena can follow it's request
+     * across threads. A moved-from arena, or an arena, that could not get a buffer from the
+     * cache, has no buffer and no memory resource, test it with operator bool before using memory().
+     *
+     * @tparam Memory memory resource type, that is constructed with (ptr, size, args...),
+     *                for example linear_memory, stack_memory or dynamic_memory
+     */
+    template<class Memory>
+    class cached_arena {
+    private:
+        using uptr = memory_resource::uintptr_type;
+        arena_buffer _buffer;
+        // the memory resource lives only while the arena owns a buffer
+        alignas(Memory) unsigned char _memory_storage[sizeof(Memory)];
+        bool _has_memory;
+
+        Memory *memory_pointer() { return reinterpret_cast<Memory *>(_memory_storage); }
+        const Memory *memory_pointer() const { return reinterpret_cast<const Memory *>(_memory_storage); }
+
+    public:
+        /**
+         * @param cache the cache of the buffers
+         * @param size_bytes minimal size of the arena in bytes
+         * @param args extra arguments for the memory resource constructor
+         */
+        template<class... Args>
+        cached_arena(arena_buffer_cache &cache, uptr size_bytes, Args &&... args) :
+                _buffer(cache.acquire(size_bytes)), _has_memory(false) {
+            // without a buffer, the upstream is out of memory, and there is nothing to build a resource on
+            if (!_buffer) return;
+            new(_memory_storage) Memory(_buffer.data(), _buffer.size(), micro_alloc::traits::forward<Args>(args)...);
+            _has_memory = true;
+        }
+        cached_arena(const cached_arena &) = delete;
+        cached_arena &operator=(const cached_arena &) = delete;
+        cached_arena(cached_arena &&other) noexcept :
+                _buffer(micro_alloc::traits::move(other._buffer)), _has_memory(other._has_memory) {
+            // the memory resource points into the buffer, so it moves with it, and the
+            // moved-from arena can not allocate into a buffer, that it does not own anymore
+            if (!_has_memory) return;
+            new(_memory_storage) Memory(*other.memory_pointer());
+            other.memory_pointer()->~Memory();
+            other._has_memory = false;
+        }
+        ~cached_arena() {
+            if (_has_memory) memory_pointer()->~Memory();
+        }
+
+        /**
+         * {false} for a moved-from arena, or an arena, that could not get a buffer
+         */
+        explicit operator bool() const { return _has_memory; }
+
+        Memory &memory() { return *memory_pointer(); }
+        const Memory &memory() const { return *memory_pointer(); }
+        Memory *operator->() { return memory_pointer(); }
+        const arena_buffer &buffer() const { return _buffer; }
+    };
+}
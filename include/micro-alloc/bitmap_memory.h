@@ -0,0 +1,359 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Bitmap Memory Resource:
+     *
+     * Variable size allocator, that tracks the memory as granules of a fixed size, where
+     * each granule is represented by a single bit. Allocations search for a run of free
+     * bits a whole machine word at a time.
+     *
+     * Allocation is O(granules-count / bits-in-word) at worst, usually much less because
+     * we keep a hint to the lowest free granule.
+     * Free is O(block-granules / bits-in-word)
+     *
+     * Notes:
+     * - Blocks have NO headers or footers, all the book-keeping lives in two bitmaps, that are
+     *   placed at the beginning of the memory:
+     *   - used bitmap, bit is on if the granule is allocated
+     *   - ends bitmap, bit is on if the granule is the last granule of an allocated block
+     * - free(pointer, size) checks the size against the ends bitmap, so it costs the same as
+     *   free(pointer), and catches a size, that does not match the block.
+     * - Granule size is aligned up to the final alignment. Every block starts at a granule.
+     * - Memory overhead is exactly 2 bits per granule, plus alignment.
+     *
+     * Safety:
+     * - free operations validate that the address is a granule inside the memory, that it is
+     *   the start of an allocated block, and for sized free, that the size matches the block.
+     *
+     * @author Tomer Riko Shalev
+     */
+    class bitmap_memory : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::align_down;
+        using base::is_aligned;
+        using base::ptr_to_int;
+        using base::int_to_ptr;
+        using base::int_to;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using base::max;
+        using base::min;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        static constexpr uptr bits_in_word() { return sizeof(uptr) * 8; }
+
+        void *_ptr;
+        uptr _size;
+        uptr _granule_size;
+        uptr _granules_count;
+        uptr _free_granules_count;
+        // lowest granule, that might be free. all granules before it are allocated
+        uptr _hint;
+        uptr *_used_map;
+        uptr *_ends_map;
+        uptr _granules_start;
+
+        static uptr words_for(uptr bits) { return (bits + bits_in_word() - 1) / bits_in_word(); }
+        uptr size_of_maps(uptr granules) const {
+            return align_up(2 * words_for(granules) * sizeof(uptr));
+        }
+
+        static uptr count_trailing_zeros(uptr word) {
+#if defined(__GNUC__) || defined(__clang__)
+            if (sizeof(uptr) > sizeof(unsigned int))
+                return uptr(__builtin_ctzll((unsigned long long)word));
+            return uptr(__builtin_ctz((unsigned int)word));
+#else
+            uptr count = 0;
+            while (!(word & 1)) { word >>= 1; ++count; }
+            return count;
+#endif
+        }
+
+        bool test_bit(const uptr *map, uptr index) const {
+            return (map[index / bits_in_word()] >> (index % bits_in_word())) & 1;
+        }
+
+        /**
+         * find the first bit in [from, limit) that equals {value}, a word at a time
+         * @return the bit index or {limit} if not found
+         */
+        uptr find_next(const uptr *map, uptr from, uptr limit, bool value) const {
+            while (from < limit) {
+                const uptr word_index = from / bits_in_word();
+                const uptr bit_index = from % bits_in_word();
+                uptr word = value ? map[word_index] : ~map[word_index];
+                word &= (~uptr(0)) << bit_index;
+                if (word) {
+                    const uptr found = word_index * bits_in_word() + count_trailing_zeros(word);
+                    return found < limit ? found : limit;
+                }
+                from = (word_index + 1) * bits_in_word();
+            }
+            return limit;
+        }
+
+        void set_range(uptr *map, uptr from, uptr count, bool value) {
+            while (count) {
+                const uptr word_index = from / bits_in_word();
+                const uptr bit_index = from % bits_in_word();
+                const uptr span = min(bits_in_word() - bit_index, count);
+                const uptr ones = span == bits_in_word() ? ~uptr(0) : ((uptr(1) << span) - 1);
+                const uptr mask = ones << bit_index;
+                if (value) map[word_index] |= mask;
+                else map[word_index] &= ~mask;
+                from += span;
+                count -= span;
+            }
+        }
+
+        uptr compute_granules_count() const {
+            const uptr start = start_aligned_address();
+            const uptr end = end_aligned_address();
+            if (end <= start) return 0;
+            const uptr total = end - start;
+            // every granule costs granule_size bytes + 2 bits, start with an estimate
+            // and walk down until the maps and granules fit
+            uptr granules = (total * 4) / (4 * _granule_size + 1);
+            while (granules && (size_of_maps(granules) + granules * _granule_size) > total)
+                granules -= 1;
+            return granules;
+        }
+
+        uptr granules_for(uptr size_bytes) const {
+            return (size_bytes + _granule_size - 1) / _granule_size;
+        }
+
+        /**
+         * resolve the granule index of an address, or {_granules_count} if it is
+         * not a granule start inside the memory
+         */
+        uptr granule_index_of(uptr address) const {
+            const uptr end = _granules_start + _granules_count * _granule_size;
+            const bool is_in_range = address >= _granules_start && address < end;
+            if (!is_in_range) return _granules_count;
+            const uptr offset = address - _granules_start;
+            if (offset % _granule_size) return _granules_count;
+            return offset / _granule_size;
+        }
+
+        bool is_block_start(uptr index) const {
+            if (!test_bit(_used_map, index)) return false;
+            if (index == 0) return true;
+            return !test_bit(_used_map, index - 1) || test_bit(_ends_map, index - 1);
+        }
+
+        void release_granules(uptr index, uptr granules) {
+            set_range(_used_map, index, granules, false);
+            set_range(_ends_map, index + granules - 1, 1, false);
+            _free_granules_count += granules;
+            if (index < _hint) _hint = index;
+        }
+
+    public:
+        uptr granule_size() const { return _granule_size; }
+        uptr granules_count() const { return _granules_count; }
+        uptr free_granules_count() const { return _free_granules_count; }
+        uptr available_size() const override { return _free_granules_count * _granule_size; }
+        uptr start_aligned_address() const { return align_up(ptr_to_int(_ptr)); }
+        uptr end_aligned_address() const { return align_down(ptr_to_int(_ptr) + _size); }
+
+        bitmap_memory() = delete;
+
+        /**
+         * ctor
+         *
+         * @param ptr start of memory
+         * @param size_bytes the memory size in bytes
+         * @param granule_size the allocation unit in bytes, aligned up to the final alignment
+         * @param alignment power of 2 alignment, that is >= alignment of pointer
+         */
+        bitmap_memory(void *ptr, uptr size_bytes, uptr granule_size = 16,
+                      uptr alignment = sizeof(uintptr_type)) :
+                base{7, max(alignment, sizeof(uintptr_type))}, _ptr(ptr), _size(size_bytes),
+                _granule_size(0), _granules_count(0), _free_granules_count(0), _hint(0),
+                _used_map(nullptr), _ends_map(nullptr), _granules_start(0) {
+            const bool is_memory_valid_1 = is_alignment_pow_2();
+            if (is_memory_valid_1) {
+                _granule_size = align_up(max(granule_size, 1));
+                _granules_count = compute_granules_count();
+            }
+            const bool is_memory_valid_2 = _granules_count > 0;
+            const bool is_memory_valid = is_memory_valid_1 and is_memory_valid_2;
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: bitmap memory resource\n";
+            std::cout << "* requested alignment is " << alignment << " bytes" << std::endl;
+            std::cout << "* final alignment is " << this->alignment << " bytes" << std::endl;
+            std::cout << "* granule size is " << _granule_size << " bytes" << std::endl;
+            std::cout << "* granules count is " << _granules_count << std::endl;
+            if (!is_memory_valid_1)
+                std::cout << "* error:: final alignment should be a power of 2\n";
+            if (!is_memory_valid_2)
+                std::cout << "* error:: memory does not satisfy minimal size requirements !!!\n";
+#endif
+            if (is_memory_valid) reset();
+            else try_throw();
+        }
+
+        ~bitmap_memory() override {
+            _ptr = nullptr;
+            _used_map = _ends_map = nullptr;
+            _size = _granules_count = _free_granules_count = 0;
+        }
+
+        /**
+         * free all blocks at once
+         */
+        void reset() {
+            const uptr words = words_for(_granules_count);
+            const uptr start = start_aligned_address();
+            _used_map = int_to<uptr *>(start);
+            _ends_map = _used_map + words;
+            _granules_start = start + size_of_maps(_granules_count);
+            for (uptr ix = 0; ix < words; ++ix) _used_map[ix] = _ends_map[ix] = 0;
+            // bits past the last granule are marked as used, so searches never stop on them
+            const uptr tail = words * bits_in_word() - _granules_count;
+            if (tail) set_range(_used_map, _granules_count, tail, true);
+            _free_granules_count = _granules_count;
+            _hint = 0;
+        }
+
+        void *malloc(uptr size_bytes) override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nMALLOC:: bitmap memory\n- requested " << size_bytes << " bytes\n";
+#endif
+            if (size_bytes == 0) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error, cannot fulfill a size 0 bytes block !!\n";
+#endif
+                try_throw();
+                return nullptr;
+            }
+
+            const uptr granules = granules_for(size_bytes);
+            uptr from = _hint;
+            uptr run_start = _granules_count;
+            while (granules <= _free_granules_count) {
+                const uptr start = find_next(_used_map, from, _granules_count, false);
+                if (start + granules > _granules_count) break;
+                const uptr stop = find_next(_used_map, start, start + granules, true);
+                if (stop == start + granules) { run_start = start; break; }
+                from = stop;
+            }
+
+            if (run_start == _granules_count) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error, could not find a run of " << granules << " free granules\n";
+                std::cout << "- free granules [" << _free_granules_count << "/" << _granules_count << "]\n";
+#endif
+                try_throw();
+                return nullptr;
+            }
+
+            set_range(_used_map, run_start, granules, true);
+            set_range(_ends_map, run_start + granules - 1, 1, true);
+            _free_granules_count -= granules;
+            if (run_start == _hint) _hint = run_start + granules;
+
+            const uptr address = _granules_start + run_start * _granule_size;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "- handed " << granules << " granules @" << address << "\n";
+            print(true);
+#endif
+            return int_to_ptr(address);
+        }
+
+        bool free(void *pointer) override {
+            const uptr address = ptr_to_int(pointer);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nFREE:: bitmap memory\n- free a block address @ " << address << "\n";
+#endif
+            const uptr index = granule_index_of(address);
+            if (index == _granules_count || !is_block_start(index)) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error: address is not a start of an allocated block\n";
+#endif
+                try_throw();
+                return false;
+            }
+            const uptr last = find_next(_ends_map, index, _granules_count, true);
+            release_granules(index, last - index + 1);
+#ifdef MICRO_ALLOC_DEBUG
+            print(true);
+#endif
+            return true;
+        }
+
+        /**
+         * free a block of a known size, the block must end exactly at the last granule of the size
+         *
+         * @param pointer pointer to free
+         * @param size_bytes the size, that was requested upon allocation
+         * @return {true/false} on success/failure
+         */
+        bool free(void *pointer, uptr size_bytes) {
+            const uptr address = ptr_to_int(pointer);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nFREE:: bitmap memory\n- free a block address @ " << address
+                      << " of " << size_bytes << " bytes\n";
+#endif
+            const uptr index = granule_index_of(address);
+            const uptr granules = granules_for(size_bytes);
+            const bool is_valid = index != _granules_count && granules &&
+                    index + granules <= _granules_count && is_block_start(index) &&
+                    find_next(_ends_map, index, index + granules, true) == index + granules - 1;
+            if (!is_valid) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error: address and size do not match an allocated block\n";
+#endif
+                try_throw();
+                return false;
+            }
+            release_granules(index, granules);
+#ifdef MICRO_ALLOC_DEBUG
+            print(true);
+#endif
+            return true;
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            if (!embed)
+                std::cout << std::endl << "PRINT:: bitmap allocator " << std::endl;
+            std::cout << "- free granules [" << _free_granules_count << "/" << _granules_count
+                      << "], lowest free granule hint is " << _hint << "\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            bool equals = this->type_id() == other.type_id();
+            if (!equals) return false;
+            const auto *casted_other = static_cast<const bitmap_memory *>(&other);
+            equals = this->_ptr == casted_other->_ptr;
+            return equals;
+        }
+    };
+}
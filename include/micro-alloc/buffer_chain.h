@@ -0,0 +1,285 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Buffer Chain:
+     *
+     * Scatter-gather buffer builder for data of unknown length, like serialized network messages.
+     * Data is appended into fixed size blocks, that are taken from a memory resource (usually a
+     * pool memory), and the blocks are linked by segments. The chain is exposed directly as iovecs
+     * for writev/sendmsg, so outgoing data is never grown contiguously or copied again.
+     *
+     * - append() is O(size), prepare()/commit() are O(1)
+     * - slice() is O(segments), it shares the blocks with the new chain, and does not copy data
+     * - consume() is O(consumed segments), it drops sent data from the front
+     *
+     * Notes:
+     * - Blocks carry a reference count, a block returns to it's resource, when the last segment,
+     *   that references it, is dropped. Counting is not atomic, chains, that share blocks,
+     *   should stay on one thread.
+     * - Segments are small nodes, that are allocated from the segments resource, which defaults
+     *   to the blocks resource. Pass a small pool memory, when the blocks are big.
+     * - Data is only appended into a block, that is not shared with other chains
+     *
+     * Block is:
+     *  [ refs | used | ..aligned data.. ]
+     *
+     * @author Tomer Riko Shalev
+     */
+    class buffer_chain {
+    public:
+        using uptr = memory_resource::uintptr_type;
+
+    private:
+        struct block_t {
+            uptr refs;
+            uptr used;
+        };
+        struct segment_t {
+            segment_t *next;
+            block_t *block;
+            uptr offset;
+            uptr length;
+        };
+
+        memory_resource *_blocks;
+        memory_resource *_segments;
+        uptr _block_size;
+        segment_t *_head;
+        segment_t *_tail;
+        uptr _size;
+        uptr _segments_count;
+
+        static constexpr uptr header_size() {
+            return (sizeof(block_t) + 2 * sizeof(uptr) - 1) & ~(2 * sizeof(uptr) - 1);
+        }
+        uptr block_capacity() const { return _block_size > header_size() ? _block_size - header_size() : 0; }
+        static unsigned char *block_data(block_t *block) {
+            return reinterpret_cast<unsigned char *>(block) + header_size();
+        }
+
+        void release_block(block_t *block) {
+            block->refs -= 1;
+            if (block->refs == 0) _blocks->free(block);
+        }
+
+        bool push_segment(block_t *block, uptr offset, uptr length) {
+            auto *segment = static_cast<segment_t *>(_segments->malloc(sizeof(segment_t)));
+            if (!segment) return false;
+            segment->next = nullptr;
+            segment->block = block;
+            segment->offset = offset;
+            segment->length = length;
+            block->refs += 1;
+            if (_tail) _tail->next = segment;
+            else _head = segment;
+            _tail = segment;
+            _size += length;
+            _segments_count += 1;
+            return true;
+        }
+
+        void pop_segment() {
+            segment_t *segment = _head;
+            _head = segment->next;
+            if (!_head) _tail = nullptr;
+            _size -= segment->length;
+            _segments_count -= 1;
+            release_block(segment->block);
+            _segments->free(segment);
+        }
+
+        bool is_tail_writable() const {
+            return _tail && _tail->block->refs == 1 &&
+                   _tail->offset + _tail->length == _tail->block->used &&
+                   _tail->block->used < block_capacity();
+        }
+
+        bool add_block() {
+            auto *block = static_cast<block_t *>(_blocks->malloc(_block_size));
+            if (!block) return false;
+            block->refs = 0;
+            block->used = 0;
+            if (push_segment(block, 0, 0)) return true;
+            _blocks->free(block);
+            return false;
+        }
+
+    public:
+        buffer_chain() = delete;
+        buffer_chain(const buffer_chain &) = delete;
+        buffer_chain &operator=(const buffer_chain &) = delete;
+
+        /**
+         * ctor
+         *
+         * @param blocks memory resource of the blocks, usually a pool memory
+         * @param block_size size of a block in bytes, including a small header
+         * @param segments memory resource of the segment nodes, {nullptr} for the blocks resource
+         */
+        buffer_chain(memory_resource *blocks, uptr block_size, memory_resource *segments = nullptr) :
+                _blocks(blocks), _segments(segments ? segments : blocks), _block_size(block_size),
+                _head(nullptr), _tail(nullptr), _size(0), _segments_count(0) {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: buffer chain of " << block_capacity() << " bytes blocks\n";
+#endif
+        }
+
+        buffer_chain(buffer_chain &&other) noexcept :
+                _blocks(other._blocks), _segments(other._segments), _block_size(other._block_size),
+                _head(other._head), _tail(other._tail), _size(other._size),
+                _segments_count(other._segments_count) {
+            other._head = other._tail = nullptr;
+            other._size = other._segments_count = 0;
+        }
+
+        ~buffer_chain() { clear(); }
+
+        /**
+         * bytes of data in the chain
+         */
+        uptr size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        uptr segments_count() const { return _segments_count; }
+
+        /**
+         * writable space at the end of the chain, a new block is linked when the last one is full
+         *
+         * @param available set to the number of writable bytes
+         * @return the space or {nullptr}
+         */
+        void *prepare(uptr &available) {
+            available = 0;
+            if (!is_tail_writable() && !add_block()) return nullptr;
+            block_t *block = _tail->block;
+            available = block_capacity() - block->used;
+            return block_data(block) + block->used;
+        }
+
+        /**
+         * commit {size_bytes} bytes, that were written into the space of prepare()
+         */
+        void commit(uptr size_bytes) {
+            _tail->block->used += size_bytes;
+            _tail->length += size_bytes;
+            _size += size_bytes;
+        }
+
+        /**
+         * copy data to the end of the chain
+         * @return {false} if the resources ran out, data, that was copied, stays in the chain
+         */
+        bool append(const void *data, uptr size_bytes) {
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            while (size_bytes) {
+                uptr available;
+                auto *space = static_cast<unsigned char *>(prepare(available));
+                if (!space) return false;
+                const uptr count = size_bytes < available ? size_bytes : available;
+                for (uptr ix = 0; ix < count; ++ix) space[ix] = bytes[ix];
+                commit(count);
+                bytes += count;
+                size_bytes -= count;
+            }
+            return true;
+        }
+
+        /**
+         * append {length} bytes from {offset} of this chain to {out} by sharing the blocks
+         * @return {false} if the range is out of bounds or the segments resource ran out
+         */
+        bool slice(uptr offset, uptr length, buffer_chain &out) const {
+            if (offset + length > _size) return false;
+            for (segment_t *segment = _head; segment && length; segment = segment->next) {
+                if (offset >= segment->length) {
+                    offset -= segment->length;
+                    continue;
+                }
+                const uptr available = segment->length - offset;
+                const uptr count = length < available ? length : available;
+                if (!out.push_segment(segment->block, segment->offset + offset, count)) return false;
+                length -= count;
+                offset = 0;
+            }
+            return true;
+        }
+
+        /**
+         * drop {size_bytes} bytes from the front of the chain, for example after a partial writev
+         */
+        void consume(uptr size_bytes) {
+            while (_head && size_bytes >= _head->length) {
+                size_bytes -= _head->length;
+                pop_segment();
+            }
+            if (_head && size_bytes) {
+                _head->offset += size_bytes;
+                _head->length -= size_bytes;
+                _size -= size_bytes;
+            }
+        }
+
+        /**
+         * drop all data, blocks, that are not shared, return to their resource
+         */
+        void clear() {
+            while (_head) pop_segment();
+        }
+
+        /**
+         * number of iovecs, that fill_iovecs() writes
+         */
+        uptr iovecs_count() const {
+            uptr count = 0;
+            for (segment_t *segment = _head; segment; segment = segment->next)
+                if (segment->length) count += 1;
+            return count;
+        }
+
+        /**
+         * write the chain as iovecs for writev/sendmsg
+         *
+         * @tparam IOVec a type with iov_base and iov_len members, like struct iovec
+         * @param out array of at least {max_count} iovecs
+         * @param max_count capacity of out
+         * @return number of iovecs written
+         */
+        template<class IOVec>
+        uptr fill_iovecs(IOVec *out, uptr max_count) const {
+            uptr count = 0;
+            for (segment_t *segment = _head; segment && count < max_count; segment = segment->next) {
+                if (!segment->length) continue;
+                out[count].iov_base = block_data(segment->block) + segment->offset;
+                out[count].iov_len = segment->length;
+                count += 1;
+            }
+            return count;
+        }
+
+        void print() const {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nPRINT:: buffer chain\n- " << _size << " bytes in " << _segments_count << " segments\n";
+            for (segment_t *segment = _head; segment; segment = segment->next)
+                std::cout << "- segment of " << segment->length << " bytes @" << segment->offset
+                          << " of block with " << segment->block->refs << " references\n";
+#endif
+        }
+    };
+}
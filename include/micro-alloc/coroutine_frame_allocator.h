@@ -0,0 +1,235 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+// coroutines are a C++20 feature, this header is empty for older standards
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#define MICRO_ALLOC_HAS_COROUTINE_FRAME_ALLOCATOR
+
+#include "memory_resource.h"
+// <atomic> and <new> are freestanding headers, they do not require the standard library
+#include <atomic>
+#include <new>
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Coroutine Frame Pool:
+     *
+     * Process wide store of coroutine frame blocks, it backs the per thread caches of
+     * coroutine_frame_allocator. Blocks are carved pool style out of big slabs, and are
+     * grouped in buckets of {granularity} bytes steps. Slabs are only returned to the
+     * system, when the pool is destroyed at program exit.
+     *
+     * - Thread safe, guarded by a spin lock, which is taken only to move batches of blocks.
+     */
+    class coroutine_frame_pool {
+    public:
+        using uptr = memory_resource::uintptr_type;
+        static constexpr uptr granularity = 64;
+        static constexpr unsigned buckets_count = 16;
+        static constexpr uptr slab_size = 64 * 1024;
+
+        struct node_t { node_t *next; };
+
+        static constexpr uptr bucket_size(unsigned bucket) { return (bucket + 1) * granularity; }
+
+        static coroutine_frame_pool &global() {
+            static coroutine_frame_pool pool;
+            return pool;
+        }
+
+        coroutine_frame_pool(const coroutine_frame_pool &) = delete;
+        coroutine_frame_pool &operator=(const coroutine_frame_pool &) = delete;
+
+        ~coroutine_frame_pool() {
+            while (_slabs) {
+                slab_t *next = _slabs->next;
+                ::operator delete(_slabs);
+                _slabs = next;
+            }
+        }
+
+        /**
+         * take a batch of at most {count} blocks of {bucket}
+         * @return a list of blocks or {nullptr}, if the system is out of memory
+         */
+        node_t *take(unsigned bucket, unsigned count) {
+            node_t *first = nullptr;
+            lock();
+            while (count && _free_lists[bucket]) {
+                node_t *node = _free_lists[bucket];
+                _free_lists[bucket] = node->next;
+                node->next = first;
+                first = node;
+                count -= 1;
+            }
+            while (count) {
+                if (_carve_head + bucket_size(bucket) > _carve_end && !grow()) break;
+                auto *node = reinterpret_cast<node_t *>(_carve_head);
+                _carve_head += bucket_size(bucket);
+                node->next = first;
+                first = node;
+                count -= 1;
+            }
+            unlock();
+            return first;
+        }
+
+        /**
+         * give back a list of blocks of {bucket}
+         */
+        void give(unsigned bucket, node_t *first, node_t *last) {
+            if (!first) return;
+            lock();
+            last->next = _free_lists[bucket];
+            _free_lists[bucket] = first;
+            unlock();
+        }
+
+    private:
+        struct slab_t { slab_t *next; };
+
+        node_t *_free_lists[buckets_count] = {};
+        slab_t *_slabs = nullptr;
+        uptr _carve_head = 0;
+        uptr _carve_end = 0;
+        std::atomic_flag _lock = ATOMIC_FLAG_INIT;
+
+        coroutine_frame_pool() = default;
+
+        void lock() { while (_lock.test_and_set(std::memory_order_acquire)); }
+        void unlock() { _lock.clear(std::memory_order_release); }
+
+        bool grow() {
+            auto *slab = static_cast<slab_t *>(::operator new(slab_size, std::nothrow));
+            if (!slab) return false;
+            slab->next = _slabs;
+            _slabs = slab;
+            _carve_head = memory_resource::align_up(reinterpret_cast<uptr>(slab) + sizeof(slab_t),
+                                                    alignof(max_align_t_));
+            _carve_end = reinterpret_cast<uptr>(slab) + slab_size;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nGROW:: coroutine frame pool\n- new slab of " << slab_size << " bytes\n";
+#endif
+            return true;
+        }
+
+        union max_align_t_ { long double a; long long b; void *c; };
+    };
+
+    /**
+     * Coroutine Frame Allocator:
+     *
+     * Per thread recycling allocator for coroutine frames. Every thread has a cache of free
+     * blocks per size bucket, allocation and deallocation are a pop and a push on it. Empty
+     * buckets refill a batch from the process wide coroutine_frame_pool, and full buckets hand
+     * back half of their blocks, so frames may be destroyed on another thread than the one,
+     * that created them.
+     *
+     * - Allocation and deallocation are O(1)
+     * - Frames larger than the largest bucket are served by the global operator new/delete
+     *
+     * Notes:
+     * - Uses sized deallocation, which coroutines always provide, so blocks carry no headers
+     * - Hook it to a coroutine with coroutine_frame_promise
+     */
+    class coroutine_frame_allocator {
+    public:
+        using uptr = memory_resource::uintptr_type;
+        using pool = coroutine_frame_pool;
+        static constexpr unsigned refill_batch = 16;
+        static constexpr unsigned max_cached_per_bucket = 64;
+
+        static coroutine_frame_allocator &local() {
+            thread_local coroutine_frame_allocator cache;
+            return cache;
+        }
+
+        coroutine_frame_allocator(const coroutine_frame_allocator &) = delete;
+        coroutine_frame_allocator &operator=(const coroutine_frame_allocator &) = delete;
+
+        ~coroutine_frame_allocator() {
+            for (unsigned bucket = 0; bucket < pool::buckets_count; ++bucket)
+                give_back(bucket, _counts[bucket]);
+        }
+
+        void *allocate(uptr size_bytes) {
+            const unsigned bucket = bucket_of(size_bytes);
+            if (bucket >= pool::buckets_count) return ::operator new(size_bytes);
+            if (!_lists[bucket]) {
+                pool::node_t *batch = pool::global().take(bucket, refill_batch);
+                if (!batch) throw std::bad_alloc();
+                _lists[bucket] = batch;
+                for (pool::node_t *node = batch; node; node = node->next) _counts[bucket] += 1;
+            }
+            pool::node_t *node = _lists[bucket];
+            _lists[bucket] = node->next;
+            _counts[bucket] -= 1;
+            return node;
+        }
+
+        void deallocate(void *pointer, uptr size_bytes) noexcept {
+            const unsigned bucket = bucket_of(size_bytes);
+            if (bucket >= pool::buckets_count) {
+                ::operator delete(pointer);
+                return;
+            }
+            auto *node = static_cast<pool::node_t *>(pointer);
+            node->next = _lists[bucket];
+            _lists[bucket] = node;
+            _counts[bucket] += 1;
+            if (_counts[bucket] > max_cached_per_bucket) give_back(bucket, max_cached_per_bucket / 2);
+        }
+
+        uptr cached_count(unsigned bucket) const { return _counts[bucket]; }
+
+    private:
+        pool::node_t *_lists[pool::buckets_count] = {};
+        uptr _counts[pool::buckets_count] = {};
+
+        coroutine_frame_allocator() = default;
+
+        static unsigned bucket_of(uptr size_bytes) {
+            return size_bytes ? unsigned((size_bytes - 1) / pool::granularity) : 0;
+        }
+
+        void give_back(unsigned bucket, uptr count) {
+            if (!count) return;
+            pool::node_t *first = _lists[bucket], *last = first;
+            for (uptr ix = 1; ix < count; ++ix) last = last->next;
+            _lists[bucket] = last->next;
+            _counts[bucket] -= count;
+            pool::global().give(bucket, first, last);
+        }
+    };
+
+    /**
+     * Promise type mixin, that allocates the coroutine frames with the coroutine_frame_allocator.
+     * Inherit your promise type from it:
+     *
+     *   struct promise_type : micro_alloc::coroutine_frame_promise { ... };
+     */
+    struct coroutine_frame_promise {
+        static void *operator new(decltype(sizeof(0)) size_bytes) {
+            return coroutine_frame_allocator::local().allocate(size_bytes);
+        }
+        static void operator delete(void *pointer, decltype(sizeof(0)) size_bytes) noexcept {
+            coroutine_frame_allocator::local().deallocate(pointer, size_bytes);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,257 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Counting Linear Memory Resource:
+     *
+     * Linear memory, that is split into chunks, where every chunk counts it's outstanding
+     * allocations. Allocation bumps a pointer inside the current chunk, free decrements the
+     * count of the chunk of the pointer, and when the count drops to zero, the chunk is
+     * recycled as a whole. This gives linear allocation speed for batch lifetimes, while
+     * staying compatible with code, that frees every allocation.
+     *
+     * - Allocations are O(1)
+     * - Free is O(1)
+     *
+     * Notes:
+     * - Allocations larger than a chunk (minus a small chunk header) are not supported
+     * - Memory of a chunk is only reused after all of it's allocations are freed, a single
+     *   long lived allocation pins it's whole chunk.
+     * - Double frees are not detected, as long as the chunk count stays positive.
+     *
+     * Chunk is:
+     *  [ count | next free chunk | ..aligned data.. ]
+     *
+     * @author Tomer Riko Shalev
+     */
+    class counting_linear_memory : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::align_down;
+        using base::is_aligned;
+        using base::ptr_to_int;
+        using base::int_to_ptr;
+        using base::int_to;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using base::max;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        struct chunk_t {
+            uptr count = 0;
+            chunk_t *next_free = nullptr;
+        };
+
+        void *_ptr;
+        uptr _size;
+        uptr _chunk_size;
+        uptr _chunks_count;
+        uptr _free_chunks_count;
+        uptr _start;
+        chunk_t *_free_chunks;
+        chunk_t *_current;
+        uptr _head;
+
+        uptr size_of_chunk_header() const { return align_up(sizeof(chunk_t)); }
+        uptr chunk_payload_size() const { return _chunk_size - size_of_chunk_header(); }
+        uptr chunk_start(const chunk_t *chunk) const { return ptr_to_int(chunk) + size_of_chunk_header(); }
+        uptr chunk_end(const chunk_t *chunk) const { return ptr_to_int(chunk) + _chunk_size; }
+        chunk_t *chunk_at(uptr index) const { return int_to<chunk_t *>(_start + index * _chunk_size); }
+
+        void push_free_chunk(chunk_t *chunk) {
+            chunk->next_free = _free_chunks;
+            _free_chunks = chunk;
+            _free_chunks_count += 1;
+        }
+
+        void make_current(chunk_t *chunk) {
+            _current = chunk;
+            _head = chunk_start(chunk);
+        }
+
+    public:
+        uptr chunk_size() const { return _chunk_size; }
+        uptr chunks_count() const { return _chunks_count; }
+        uptr free_chunks_count() const { return _free_chunks_count; }
+        uptr start_aligned_address() const { return align_up(ptr_to_int(_ptr)); }
+        uptr end_aligned_address() const { return align_down(ptr_to_int(_ptr) + _size); }
+
+        /**
+         * bytes left in the current chunk plus the payload of all the free chunks
+         */
+        uptr available_size() const override {
+            if (!_current) return 0;
+            return (chunk_end(_current) - _head) + _free_chunks_count * chunk_payload_size();
+        }
+
+        counting_linear_memory() = delete;
+
+        /**
+         * ctor
+         *
+         * @param ptr start of memory
+         * @param size_bytes the memory size in bytes
+         * @param chunk_size the size of a chunk in bytes, which is also the largest allocation
+         * @param alignment power of 2 alignment, that is >= alignment of pointer
+         */
+        counting_linear_memory(void *ptr, uptr size_bytes, uptr chunk_size, uptr alignment = sizeof(uintptr_type)) :
+                base{13, max(alignment, sizeof(uintptr_type))}, _ptr(ptr), _size(size_bytes),
+                _chunk_size(0), _chunks_count(0), _free_chunks_count(0), _start(0),
+                _free_chunks(nullptr), _current(nullptr), _head(0) {
+            const bool is_memory_valid_1 = is_alignment_pow_2();
+            if (is_memory_valid_1) {
+                _chunk_size = align_up(chunk_size);
+                const bool has_payload = _chunk_size > size_of_chunk_header();
+                const uptr start = start_aligned_address(), end = end_aligned_address();
+                _chunks_count = has_payload && end > start ? (end - start) / _chunk_size : 0;
+            }
+            const bool is_memory_valid_2 = _chunks_count > 0;
+            const bool is_memory_valid = is_memory_valid_1 and is_memory_valid_2;
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: counting linear memory resource\n";
+            std::cout << "* final alignment is " << this->alignment << " bytes" << std::endl;
+            std::cout << "* chunk size is " << _chunk_size << " bytes" << std::endl;
+            std::cout << "* chunks count is " << _chunks_count << std::endl;
+            if (!is_memory_valid_1)
+                std::cout << "* error:: final alignment should be a power of 2\n";
+            if (!is_memory_valid_2)
+                std::cout << "* error:: memory does not satisfy minimal size requirements !!!\n";
+#endif
+            if (is_memory_valid) reset();
+            else try_throw();
+        }
+
+        ~counting_linear_memory() override {
+            _free_chunks = _current = nullptr;
+            _ptr = nullptr;
+            _size = _chunks_count = _free_chunks_count = 0;
+        }
+
+        /**
+         * free all blocks at once
+         */
+        void reset() {
+            _start = start_aligned_address();
+            _free_chunks = nullptr;
+            _free_chunks_count = 0;
+            for (uptr ix = _chunks_count; ix > 1; --ix) {
+                *chunk_at(ix - 1) = chunk_t();
+                push_free_chunk(chunk_at(ix - 1));
+            }
+            *chunk_at(0) = chunk_t();
+            make_current(chunk_at(0));
+        }
+
+        void *malloc(uptr size_bytes) override {
+            size_bytes = align_up(size_bytes);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nMALLOC:: counting linear memory\n- requested " << size_bytes << " bytes (aligned up)\n";
+#endif
+            const bool is_possible = _current && size_bytes && size_bytes <= chunk_payload_size();
+            if (!is_possible) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error, size is 0 or bigger than a chunk\n";
+#endif
+                try_throw();
+                return nullptr;
+            }
+
+            if (_head + size_bytes > chunk_end(_current)) {
+                if (_current->count == 0) {
+                    // nothing is alive in the current chunk, start it over
+                    make_current(_current);
+                } else if (_free_chunks) {
+                    chunk_t *chunk = _free_chunks;
+                    _free_chunks = chunk->next_free;
+                    _free_chunks_count -= 1;
+                    chunk->next_free = nullptr;
+                    make_current(chunk);
+#ifdef MICRO_ALLOC_DEBUG
+                    std::cout << "- moved to a recycled chunk @" << ptr_to_int(chunk) << "\n";
+#endif
+                } else {
+#ifdef MICRO_ALLOC_DEBUG
+                    std::cout << "- error, no free chunks are available\n";
+#endif
+                    try_throw();
+                    return nullptr;
+                }
+            }
+
+            const uptr address = _head;
+            _head += size_bytes;
+            _current->count += 1;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "- handed a block @" << address << ", chunk has " << _current->count
+                      << " outstanding allocations\n";
+#endif
+            return int_to_ptr(address);
+        }
+
+        bool free(void *pointer) override {
+            const uptr address = ptr_to_int(pointer);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nFREE:: counting linear memory\n- free a block address @ " << address << "\n";
+#endif
+            const bool is_in_range = address >= _start && address < _start + _chunks_count * _chunk_size;
+            chunk_t *chunk = is_in_range ? chunk_at((address - _start) / _chunk_size) : nullptr;
+            const bool is_valid = chunk && is_aligned(address) && address >= chunk_start(chunk) &&
+                                  chunk->count > 0;
+            if (!is_valid) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error: address is not of an allocated block\n";
+#endif
+                try_throw();
+                return false;
+            }
+
+            chunk->count -= 1;
+            if (chunk->count == 0) {
+                if (chunk == _current) make_current(chunk);
+                else push_free_chunk(chunk);
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- chunk @" << ptr_to_int(chunk) << " has no outstanding allocations, recycled\n";
+#endif
+            }
+            return true;
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            if (!embed)
+                std::cout << std::endl << "PRINT:: counting linear memory " << std::endl;
+            std::cout << "- free chunks [" << _free_chunks_count << "/" << _chunks_count
+                      << "], available size is " << available_size() << "\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            bool equals = this->type_id() == other.type_id();
+            if (!equals) return false;
+            const auto *casted_other = static_cast<const counting_linear_memory *>(&other);
+            equals = this->_ptr == casted_other->_ptr;
+            return equals;
+        }
+    };
+}
@@ -0,0 +1,171 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+#include "std_memory.h"
+#include "traits.h"
+
+namespace micro_alloc {
+
+    namespace detail {
+        /**
+         * the default resource of the calling thread, {nullptr} means the process wide std_memory.
+         * It is zero initialized, so reading it is a single TLS load without an init guard.
+         */
+        inline memory_resource *&thread_default_resource() {
+            static thread_local memory_resource *resource = nullptr;
+            return resource;
+        }
+
+        inline memory_resource *fallback_resource() {
+            static std_memory memory;
+            return &memory;
+        }
+    }
+
+    /**
+     * @return the default memory resource of the calling thread, that is the resource of the innermost
+     *         scoped_resource, or a process wide std_memory if there is none
+     */
+    inline memory_resource *get_default_resource() noexcept {
+        memory_resource *resource = detail::thread_default_resource();
+        return resource ? resource : detail::fallback_resource();
+    }
+
+    /**
+     * replace the default memory resource of the calling thread, {nullptr} restores std_memory
+     * @return the previous default resource, or {nullptr} if it was std_memory
+     */
+    inline memory_resource *set_default_resource(memory_resource *resource) noexcept {
+        memory_resource *&current = detail::thread_default_resource();
+        memory_resource *previous = current;
+        current = resource;
+        return previous;
+    }
+
+    /**
+     * Scoped Resource:
+     *
+     * Makes a memory resource the default resource of the calling thread for the lifetime of the scope,
+     * the previous default is restored when the scope ends. Scopes nest, so the defaults of a thread
+     * form a stack, that lives on the call stack itself.
+     *
+     * By default the scope only points to a resource, that is owned elsewhere. With a concrete
+     * {Resource} type, the scope constructs and owns the resource, for example a request arena:
+     *
+     *  scoped_resource<linear_memory> arena{buffer, size};
+     *
+     * Notes:
+     * - Allocations made inside the scope must be released before the scope ends, including the
+     *   allocations of containers, that use default_allocator
+     * - Scopes must end in reverse order, and on the thread, that created them
+     *
+     * @tparam Resource the resource type to own, or memory_resource to point to a resource
+     */
+    template<class Resource = memory_resource>
+    class scoped_resource {
+    private:
+        Resource _resource;
+        memory_resource *_previous;
+
+    public:
+        scoped_resource(const scoped_resource &) = delete;
+        scoped_resource &operator=(const scoped_resource &) = delete;
+
+        template<class... Args>
+        explicit scoped_resource(Args &&... args) :
+                _resource(micro_alloc::traits::forward<Args>(args)...),
+                _previous(set_default_resource(&_resource)) {}
+
+        ~scoped_resource() { set_default_resource(_previous); }
+
+        Resource &resource() noexcept { return _resource; }
+        const Resource &resource() const noexcept { return _resource; }
+    };
+
+    template<>
+    class scoped_resource<memory_resource> {
+    private:
+        memory_resource *_resource;
+        memory_resource *_previous;
+
+    public:
+        scoped_resource(const scoped_resource &) = delete;
+        scoped_resource &operator=(const scoped_resource &) = delete;
+
+        explicit scoped_resource(memory_resource *resource) noexcept :
+                _resource(resource), _previous(set_default_resource(resource)) {}
+
+        ~scoped_resource() { set_default_resource(_previous); }
+
+        memory_resource &resource() const noexcept { return *_resource; }
+    };
+
+    /**
+     * Default Allocator:
+     *
+     * Stateless allocator, that allocates from the default resource of the calling thread. The resource
+     * is resolved on every allocate() and deallocate() with a single thread local load, so deep call trees
+     * allocate from the arena of the innermost scoped_resource, without passing it around.
+     *
+     * Notes:
+     * - A block must be deallocated under the same default resource, that allocated it, so containers
+     *   of this allocator must not outlive the scope, that they allocated in, and must not be handed
+     *   to other threads
+     * - The allocation itself still calls the memory_resource::malloc/free virtual methods, only the
+     *   lookup of the resource is saved
+     * - Use polymorphic_allocator with get_default_resource(), to capture the resource once instead
+     *
+     * @tparam T the allocated object type
+     */
+    template<typename T=unsigned char>
+    class default_allocator {
+    public:
+        using value_type = T;
+        using size_t = uintptr_type;
+        using size_type = size_t;
+        using difference_type = long;
+        // stateless, the resource is the same for every instance in the same scope
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::true_type;
+
+        template<class U>
+        default_allocator(const default_allocator<U> &) noexcept {}
+        default_allocator() = default;
+
+        template<class U, class... Args>
+        void construct(U *p, Args &&... args) {
+            ::new(p) U(micro_alloc::traits::forward<Args>(args)...);
+        }
+
+        template<class U> void destroy(U *p) { p->~U(); }
+
+        T *allocate(size_t n) { return (T *) get_default_resource()->malloc(n * sizeof(T)); }
+        void deallocate(T *p, size_t = 0) { get_default_resource()->free(p); }
+
+        template<class U> struct rebind {
+            typedef default_allocator<U> other;
+        };
+    };
+
+    template<class T1, class T2>
+    bool operator==(const default_allocator<T1> &, const default_allocator<T2> &) noexcept {
+        return true;
+    }
+
+    template<class T1, class T2>
+    bool operator!=(const default_allocator<T1> &, const default_allocator<T2> &) noexcept {
+        return false;
+    }
+}
@@ -90,7 +90,7 @@ namespace micro_alloc {
         header_t * _free_list_root = nullptr;
         uptr _allocations;
         void *_ptr;
-        uint _size;
+        uptr _size;
 
         struct block_t {
             uptr aligned_from = 0, aligned_to = 0;
@@ -142,20 +142,20 @@ namespace micro_alloc {
         static uptr size_of_free_block_header() { return sizeof(header_t); }
         static uptr size_of_block_base_header() { return sizeof(base_header_t); }
         static uptr size_of_block_footer() { return sizeof(footer_t); }
-        uint minimal_size_of_any_block() {
+        uptr minimal_size_of_any_block() {
             return align_up(size_of_free_block_header()) +
                    align_up(size_of_block_footer());
         }
-        uint aligned_base_header_and_footer() {
+        uptr aligned_base_header_and_footer() {
             // minus the next prev pointers
             return (align_up(size_of_block_base_header()) +
                     align_up(size_of_block_footer()));
         }
-        uint effective_payload_size_of_block(header_t *block) {
+        uptr effective_payload_size_of_block(header_t *block) {
             // minus the next prev pointers
             return block->base.size() - aligned_base_header_and_footer();
         }
-        uptr compute_required_block_size_by_payload_size(uint payload_size) {
+        uptr compute_required_block_size_by_payload_size(uptr payload_size) {
             payload_size = align_up(payload_size);
             auto allocated_block = align_up(size_of_block_base_header()) +
                                    align_up(size_of_block_footer()) + payload_size;
@@ -165,7 +165,7 @@ namespace micro_alloc {
             return allocated_block;
         }
 
-        header_t *split_free_block_to_two_by_payload_size(header_t *block, uint payload_size) {
+        header_t *split_free_block_to_two_by_payload_size(header_t *block, uptr payload_size) {
             payload_size = align_up(payload_size);
             // size of left allocated block
             uptr required_allocated_block_size =
@@ -320,6 +320,64 @@ namespace micro_alloc {
             return ptr;
         }
 
+        /**
+         * grows an allocated block in place by taking over it's free right neighbour, the rest
+         * of the neighbour stays a free block if it is big enough. Blocks do not shrink.
+         */
+        bool expand(void *pointer, uptr size_bytes) override {
+            const uptr address = ptr_to_int(pointer);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nEXPAND:: dynamic allocator\n- request to resize block @" << address
+                      << " to " << size_bytes << " bytes\n";
+#endif
+            if (!is_aligned(address) || size_bytes == 0) return false;
+            const auto block = get_block(address - align_up(size_of_block_base_header()));
+            if (!block.sanity_test() || !block.is_allocated()) return false;
+            const uptr old_size = block.size();
+            const uptr required_size = compute_required_block_size_by_payload_size(size_bytes);
+            if (required_size <= old_size) return true;
+
+            const bool is_last_block = end_aligned_address() == block.aligned_to;
+            if (is_last_block) return false;
+            const auto right_block = get_block(block.aligned_to);
+            const uptr merged_size = old_size + right_block.size();
+            if (right_block.is_allocated() || merged_size < required_size) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- failure, right block is allocated or too small\n";
+#endif
+                return false;
+            }
+
+            // the right block leaves the free list, and a leftover free block takes it's place
+            header_t *prev = right_block.header()->prev;
+            header_t *next = right_block.header()->next;
+            uptr final_size = merged_size;
+            header_t *leftover = nullptr;
+            if (merged_size - required_size >= minimal_size_of_any_block() + this->alignment) {
+                final_size = required_size;
+                leftover = create_free_block(block.aligned_from + required_size,
+                                             block.aligned_from + merged_size).header();
+                leftover->prev = prev;
+                leftover->next = next;
+            }
+            header_t *replacement = leftover ? leftover : next;
+            if (prev) prev->next = replacement;
+            else _free_list_root = replacement;
+            if (next) next->prev = leftover ? leftover : prev;
+
+            block_t grown;
+            grown.aligned_from = block.aligned_from;
+            grown.aligned_to = block.aligned_from + final_size;
+            grown.allocator = this;
+            grown.set_size_and_status(final_size, true);
+            _allocations += final_size - old_size;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "- success, block grew to " << final_size << " bytes\n";
+            print(true);
+#endif
+            return true;
+        }
+
         bool free(void *pointer) override {
             auto address = this->ptr_to_int(pointer);
 
@@ -0,0 +1,427 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+#include "utils.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MICRO_ALLOC_FLAT_HASH_MAP_SSE2
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Hash functions of flat_hash_map, specialize it for your own key types
+     */
+    template<class T> struct hash;
+
+    namespace detail {
+        inline uintptr_type mix_hash(unsigned long long value) {
+            // splitmix64 finalizer
+            value ^= value >> 30; value *= 0xbf58476d1ce4e5b9ULL;
+            value ^= value >> 27; value *= 0x94d049bb133111ebULL;
+            value ^= value >> 31;
+            return uintptr_type(value);
+        }
+    }
+
+#define MICRO_ALLOC_INTEGRAL_HASH(type) \
+    template<> struct hash<type> { \
+        uintptr_type operator()(type value) const { return detail::mix_hash((unsigned long long)value); } \
+    };
+    MICRO_ALLOC_INTEGRAL_HASH(bool)
+    MICRO_ALLOC_INTEGRAL_HASH(char)
+    MICRO_ALLOC_INTEGRAL_HASH(signed char)
+    MICRO_ALLOC_INTEGRAL_HASH(unsigned char)
+    MICRO_ALLOC_INTEGRAL_HASH(short)
+    MICRO_ALLOC_INTEGRAL_HASH(unsigned short)
+    MICRO_ALLOC_INTEGRAL_HASH(int)
+    MICRO_ALLOC_INTEGRAL_HASH(unsigned int)
+    MICRO_ALLOC_INTEGRAL_HASH(long)
+    MICRO_ALLOC_INTEGRAL_HASH(unsigned long)
+    MICRO_ALLOC_INTEGRAL_HASH(long long)
+    MICRO_ALLOC_INTEGRAL_HASH(unsigned long long)
+#undef MICRO_ALLOC_INTEGRAL_HASH
+
+    template<class T> struct hash<T *> {
+        uintptr_type operator()(T *value) const { return detail::mix_hash((unsigned long long)(uintptr_type)value); }
+    };
+
+    namespace detail {
+
+        /**
+         * a group of 16 control bytes, that is matched at once with SSE2, or two 64 bit words (SWAR)
+         */
+        struct control_group {
+            static constexpr unsigned width = 16;
+            static constexpr signed char empty = -128;   // 0b10000000
+            static constexpr signed char deleted = -2;   // 0b11111110
+
+            const signed char *_bytes;
+
+            explicit control_group(const signed char *bytes) : _bytes(bytes) {}
+
+#ifdef MICRO_ALLOC_FLAT_HASH_MAP_SSE2
+            unsigned match(signed char h2) const {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_bytes));
+                return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+            }
+            unsigned match_empty() const { return match(empty); }
+            unsigned match_empty_or_deleted() const {
+                // both have the sign bit set
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_bytes));
+                return unsigned(_mm_movemask_epi8(bytes));
+            }
+#else
+            static constexpr unsigned long long lsbs = 0x0101010101010101ULL;
+            static constexpr unsigned long long msbs = 0x8080808080808080ULL;
+
+            static unsigned long long load(const signed char *bytes) {
+                unsigned long long word = 0;
+                for (unsigned ix = 0; ix < 8; ++ix)
+                    word |= (unsigned long long)(unsigned char)bytes[ix] << (8 * ix);
+                return word;
+            }
+            // gather the high bit of every byte into an 8 bit mask
+            static unsigned compress(unsigned long long high_bits) {
+                return unsigned(((high_bits >> 7) * 0x0102040810204080ULL) >> 56);
+            }
+            // zero bytes test may report false positives above a real match, keys are compared anyway
+            static unsigned match_word(unsigned long long word, signed char h2) {
+                const unsigned long long x = word ^ (lsbs * (unsigned char)h2);
+                return compress((x - lsbs) & ~x & msbs);
+            }
+            unsigned match(signed char h2) const {
+                return match_word(load(_bytes), h2) | (match_word(load(_bytes + 8), h2) << 8);
+            }
+            unsigned match_empty() const {
+                // empty is the only value with the sign bit set, and bit 1 cleared
+                const unsigned long long a = load(_bytes), b = load(_bytes + 8);
+                return compress(a & ~(a << 6) & msbs) | (compress(b & ~(b << 6) & msbs) << 8);
+            }
+            unsigned match_empty_or_deleted() const {
+                return compress(load(_bytes) & msbs) | (compress(load(_bytes + 8) & msbs) << 8);
+            }
+#endif
+        };
+
+        inline unsigned lowest_bit(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+            return unsigned(__builtin_ctz(mask));
+#else
+            unsigned index = 0;
+            while (!(mask & 1u)) { mask >>= 1; index += 1; }
+            return index;
+#endif
+        }
+    }
+
+    /**
+     * Entry of a flat_hash_map
+     */
+    template<class K, class V>
+    struct map_entry {
+        K key;
+        V value;
+    };
+
+    /**
+     * Flat Hash Map:
+     *
+     * Open addressing hash map in the style of Swiss tables. Every slot has a control byte,
+     * that holds 7 bits of the hash of it's key, or an empty/deleted marker. Lookups probe groups
+     * of 16 control bytes at once (SSE2, or 64 bit words without it), and compare keys only for
+     * matching control bytes. Control bytes and entries share a single allocation of a micro-alloc
+     * allocator, so building a table costs a handful of allocations, not one per insert.
+     *
+     * - Lookup, insert and erase are O(1) on average
+     * - Growth doubles the capacity, and moves all the entries
+     *
+     * Notes:
+     * - Max load factor is 7/8
+     * - Entries are destroyed only if they are not trivially destructible
+     * - abandon() drops the table without destroying or deallocating anything, for tables of
+     *   trivially destructible entries in an arena, that is about to be reset
+     * - Pointers to entries are invalidated by growth
+     *
+     * @tparam K key type, compared with operator==
+     * @tparam V value type
+     * @tparam Alloc allocator type
+     * @tparam Hash hash function type
+     */
+    template<class K, class V, class Alloc, class Hash = micro_alloc::hash<K>>
+    class flat_hash_map : private detail::allocator_holder<typename Alloc::template rebind<char>::other> {
+    public:
+        using entry_type = map_entry<K, V>;
+        using size_type = uintptr_type;
+        using allocator_type = typename Alloc::template rebind<char>::other;
+
+        struct insert_result {
+            V *value;
+            bool inserted;
+        };
+
+    private:
+        using holder = detail::allocator_holder<allocator_type>;
+        using group = detail::control_group;
+        static constexpr bool is_trivial_entry = micro_alloc::traits::is_trivially_destructible<entry_type>::value;
+
+        signed char *_control;
+        entry_type *_entries;
+        size_type _capacity;
+        size_type _size;
+        size_type _deleted;
+        Hash _hash;
+
+        static size_type entries_offset(size_type capacity) {
+            return (capacity + alignof(entry_type) - 1) & ~size_type(alignof(entry_type) - 1);
+        }
+        static size_type allocation_size(size_type capacity) {
+            return entries_offset(capacity) + capacity * sizeof(entry_type);
+        }
+        static signed char h2_of(uintptr_type hash) { return (signed char)(hash & 0x7F); }
+        static uintptr_type h1_of(uintptr_type hash) { return hash >> 7; }
+        size_type groups_count() const { return _capacity / group::width; }
+        size_type max_load() const { return _capacity - _capacity / 8; }
+
+        /**
+         * find the slot of {key}, or {_capacity} if it is missing
+         */
+        size_type find_slot(const K &key) const {
+            if (_capacity == 0) return _capacity;
+            const uintptr_type hash = _hash(key);
+            const signed char h2 = h2_of(hash);
+            size_type group_index = h1_of(hash) & (groups_count() - 1);
+            for (size_type probe = 1; probe <= groups_count(); ++probe) {
+                const group g(_control + group_index * group::width);
+                for (unsigned mask = g.match(h2); mask; mask &= mask - 1) {
+                    const size_type slot = group_index * group::width + detail::lowest_bit(mask);
+                    if (_entries[slot].key == key) return slot;
+                }
+                if (g.match_empty()) return _capacity;
+                group_index = (group_index + probe) & (groups_count() - 1);
+            }
+            return _capacity;
+        }
+
+        /**
+         * first empty or deleted slot in the probe sequence of {hash}
+         */
+        size_type find_free_slot(uintptr_type hash) const {
+            size_type group_index = h1_of(hash) & (groups_count() - 1);
+            for (size_type probe = 1;; ++probe) {
+                const unsigned mask = group(_control + group_index * group::width).match_empty_or_deleted();
+                if (mask) return group_index * group::width + detail::lowest_bit(mask);
+                group_index = (group_index + probe) & (groups_count() - 1);
+            }
+        }
+
+        void destroy_entries() {
+            if (is_trivial_entry) return;
+            for (size_type ix = 0; ix < _capacity; ++ix)
+                if (_control[ix] >= 0) _entries[ix].~entry_type();
+        }
+
+        void deallocate() {
+            if (_control) holder::allocator().deallocate(reinterpret_cast<char *>(_control), allocation_size(_capacity));
+            _control = nullptr;
+            _entries = nullptr;
+            _capacity = _size = _deleted = 0;
+        }
+
+        /**
+         * a table, that was replaced by begin_rehash(), and still holds the entries
+         */
+        struct old_table {
+            signed char *control;
+            entry_type *entries;
+            size_type capacity;
+        };
+
+        /**
+         * switch to a new empty table of {capacity} slots, a power of 2 >= 16, the entries stay in {old}
+         * until finish_rehash(), so new entries can be built from references into the old table
+         */
+        bool begin_rehash(size_type capacity, old_table &old) {
+            char *memory = holder::allocator().allocate(allocation_size(capacity));
+            if (memory == nullptr) return false;
+            old = old_table{_control, _entries, _capacity};
+            _control = reinterpret_cast<signed char *>(memory);
+            _entries = reinterpret_cast<entry_type *>(memory + entries_offset(capacity));
+            _capacity = capacity;
+            _deleted = 0;
+            for (size_type ix = 0; ix < capacity; ++ix) _control[ix] = group::empty;
+            return true;
+        }
+
+        /**
+         * move the entries of the {old} table into the new table, and free it
+         */
+        void finish_rehash(const old_table &old) {
+            for (size_type ix = 0; ix < old.capacity; ++ix) {
+                if (old.control[ix] < 0) continue;
+                entry_type &entry = old.entries[ix];
+                const uintptr_type hash = _hash(entry.key);
+                const size_type slot = find_free_slot(hash);
+                _control[slot] = h2_of(hash);
+                relocate(&entry, 1, _entries + slot);
+            }
+            if (old.control)
+                holder::allocator().deallocate(reinterpret_cast<char *>(old.control), allocation_size(old.capacity));
+        }
+
+        /**
+         * move all the entries into a new table of {capacity} slots, a power of 2 >= 16
+         */
+        bool rehash(size_type capacity) {
+            old_table old;
+            if (!begin_rehash(capacity, old)) return false;
+            finish_rehash(old);
+            return true;
+        }
+
+        /**
+         * make room for one more entry, the entries of a replaced table are left in {old}
+         */
+        bool grow_if_needed(old_table &old) {
+            old = old_table{nullptr, nullptr, 0};
+            if (_capacity && _size + _deleted + 1 <= max_load()) return true;
+            // many tombstones, rehash in place size, otherwise double
+            size_type capacity = _capacity ? _capacity : group::width;
+            if (_capacity && _size + 1 > max_load() / 2) capacity = _capacity * 2;
+            return begin_rehash(capacity, old);
+        }
+
+    public:
+        flat_hash_map() : holder(), _control(nullptr), _entries(nullptr), _capacity(0), _size(0), _deleted(0), _hash() {}
+        explicit flat_hash_map(const Alloc &alloc, const Hash &hash = Hash()) :
+                holder(allocator_type(alloc)), _control(nullptr), _entries(nullptr),
+                _capacity(0), _size(0), _deleted(0), _hash(hash) {}
+        flat_hash_map(const flat_hash_map &) = delete;
+        flat_hash_map &operator=(const flat_hash_map &) = delete;
+        flat_hash_map(flat_hash_map &&other) noexcept :
+                holder(other.get_allocator()), _control(other._control), _entries(other._entries),
+                _capacity(other._capacity), _size(other._size), _deleted(other._deleted), _hash(other._hash) {
+            other._control = nullptr;
+            other._entries = nullptr;
+            other._capacity = other._size = other._deleted = 0;
+        }
+        ~flat_hash_map() {
+            destroy_entries();
+            deallocate();
+        }
+
+        const allocator_type &get_allocator() const { return holder::allocator(); }
+        size_type size() const { return _size; }
+        size_type capacity() const { return _capacity; }
+        bool empty() const { return _size == 0; }
+
+        /**
+         * make room for {count} entries without growth
+         */
+        bool reserve(size_type count) {
+            size_type capacity = _capacity ? _capacity : group::width;
+            while (capacity - capacity / 8 < count) capacity *= 2;
+            return capacity == _capacity || rehash(capacity);
+        }
+
+        V *find(const K &key) {
+            const size_type slot = find_slot(key);
+            return slot == _capacity ? nullptr : &_entries[slot].value;
+        }
+        const V *find(const K &key) const {
+            const size_type slot = find_slot(key);
+            return slot == _capacity ? nullptr : &_entries[slot].value;
+        }
+        bool contains(const K &key) const { return find_slot(key) != _capacity; }
+
+        /**
+         * construct a value for {key} with {args}, if {key} is missing
+         * @return the value of {key}, and whether it was inserted, value is {nullptr} if the allocation failed
+         */
+        template<class... Args>
+        insert_result try_emplace(const K &key, Args &&... args) {
+            const size_type found = find_slot(key);
+            if (found != _capacity) return insert_result{&_entries[found].value, false};
+            old_table old;
+            if (!grow_if_needed(old)) return insert_result{nullptr, false};
+            const uintptr_type hash = _hash(key);
+            const size_type slot = find_free_slot(hash);
+            if (_control[slot] == group::deleted) _deleted -= 1;
+            _control[slot] = h2_of(hash);
+            entry_type *entry = _entries + slot;
+            new(&entry->key) K(key);
+            new(&entry->value) V(micro_alloc::traits::forward<Args>(args)...);
+            // {key} and {args} may point into the old table, so it is freed after the entry is built
+            finish_rehash(old);
+            _size += 1;
+            return insert_result{&entry->value, true};
+        }
+
+        /**
+         * insert or assign the value of {key}
+         * @return the value or {nullptr} if the allocation failed
+         */
+        template<class U>
+        V *insert(const K &key, U &&value) {
+            insert_result result = try_emplace(key, micro_alloc::traits::forward<U>(value));
+            if (result.value && !result.inserted) *result.value = micro_alloc::traits::forward<U>(value);
+            return result.value;
+        }
+
+        /**
+         * @return {true} if {key} was erased
+         */
+        bool erase(const K &key) {
+            const size_type slot = find_slot(key);
+            if (slot == _capacity) return false;
+            _entries[slot].~entry_type();
+            // a slot, that no probe sequence passed through as full, can become empty again
+            const bool group_has_empty = group(_control + (slot & ~size_type(group::width - 1))).match_empty() != 0;
+            _control[slot] = group_has_empty ? group::empty : group::deleted;
+            if (!group_has_empty) _deleted += 1;
+            _size -= 1;
+            return true;
+        }
+
+        /**
+         * erase all the entries, the capacity is kept
+         */
+        void clear() {
+            destroy_entries();
+            for (size_type ix = 0; ix < _capacity; ++ix) _control[ix] = group::empty;
+            _size = _deleted = 0;
+        }
+
+        /**
+         * forget the table without destroying entries or deallocating memory, use it before the
+         * arena of the allocator is reset, available only for trivially destructible entries
+         */
+        void abandon() {
+            static_assert(micro_alloc::traits::is_trivially_destructible<entry_type>::value,
+                          "abandon() would leak the resources of the entries");
+            _control = nullptr;
+            _entries = nullptr;
+            _capacity = _size = _deleted = 0;
+        }
+
+        /**
+         * call {fn(key, value)} for every entry
+         */
+        template<class Fn>
+        void for_each(Fn &&fn) {
+            for (size_type ix = 0; ix < _capacity; ++ix)
+                if (_control[ix] >= 0) fn(_entries[ix].key, _entries[ix].value);
+        }
+    };
+}
@@ -0,0 +1,163 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "linear_memory.h"
+// <new> is a freestanding header, it is used for placement new
+#include <new>
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Frame Memory Resource:
+     *
+     * N-buffered linear memory for tick based workloads. The memory is split into {Frames}
+     * linear memory arenas, allocations of frame N are served by arena (N % Frames), and
+     * live until the end of frame (N + Frames - 1).
+     *
+     * - Allocations are O(1)
+     * - Free does not do anything, use advance_frame() instead
+     * - advance_frame() is O(1), it moves to the next arena and resets it
+     *
+     * Notes:
+     * - The default is double buffering, data allocated in frame N lives until the end of frame N+1
+     * - Each arena gets an equal share of the memory
+     *
+     * @tparam Frames number of arenas, that are alive at the same time, >= 1
+     *
+     * @author Tomer Riko Shalev
+     */
+    template<unsigned Frames=2>
+    class frame_memory : public memory_resource {
+        static_assert(Frames > 0, "frame_memory requires at least one frame");
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_down;
+        using base::ptr_to_int;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        alignas(linear_memory) unsigned char _arenas[Frames][sizeof(linear_memory)];
+        void *_ptr;
+        uptr _size;
+        unsigned _current;
+        uptr _frame;
+
+        linear_memory &arena_at(unsigned index) {
+            return *reinterpret_cast<linear_memory *>(_arenas[index]);
+        }
+        const linear_memory &arena_at(unsigned index) const {
+            return *reinterpret_cast<const linear_memory *>(_arenas[index]);
+        }
+
+    public:
+        static constexpr unsigned frames_count() { return Frames; }
+
+        frame_memory() = delete;
+        frame_memory(const frame_memory &) = delete;
+        frame_memory &operator=(const frame_memory &) = delete;
+
+        /**
+         * ctor
+         *
+         * @param ptr start of memory
+         * @param size_bytes the memory size in bytes, it is split equally between the frames
+         * @param alignment power of 2 alignment
+         */
+        frame_memory(void *ptr, uptr size_bytes, uptr alignment = sizeof(uintptr_type)) :
+                base{10, alignment}, _ptr(ptr), _size(size_bytes), _current(0), _frame(0) {
+            const uptr arena_size = size_bytes / Frames;
+            for (unsigned ix = 0; ix < Frames; ++ix) {
+                void *arena_ptr = base::int_to_ptr(ptr_to_int(ptr) + ix * arena_size);
+                new(_arenas[ix]) linear_memory(arena_ptr, arena_size, alignment);
+            }
+            const bool is_memory_valid = is_alignment_pow_2() && arena_at(0).is_valid();
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: frame memory resource\n";
+            std::cout << "* frames count is " << Frames << std::endl;
+            std::cout << "* each frame arena is " << arena_size << " bytes" << std::endl;
+            if (!is_memory_valid)
+                std::cout << "* error:: memory does not satisfy requirements !!!\n";
+#endif
+            if (!is_memory_valid) try_throw();
+        }
+
+        ~frame_memory() override {
+            for (unsigned ix = 0; ix < Frames; ++ix) arena_at(ix).~linear_memory();
+            _ptr = nullptr;
+            _size = 0;
+        }
+
+        /**
+         * the frame number, starts at 0 and increases with every advance_frame()
+         */
+        uptr frame() const { return _frame; }
+        linear_memory &current_arena() { return arena_at(_current); }
+        const linear_memory &current_arena() const { return arena_at(_current); }
+
+        /**
+         * Move to the next frame, the arena of frame (N - Frames + 1) is reset and
+         * becomes the arena of the new frame.
+         */
+        void advance_frame() {
+            _current = (_current + 1) % Frames;
+            _frame += 1;
+            arena_at(_current).reset();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nADVANCE:: frame memory\n- frame #" << _frame
+                      << " uses arena #" << _current << "\n";
+#endif
+        }
+
+        /**
+         * reset all of the arenas, and start over at frame 0
+         */
+        void reset() {
+            for (unsigned ix = 0; ix < Frames; ++ix) arena_at(ix).reset();
+            _current = 0;
+            _frame = 0;
+        }
+
+        uptr available_size() const override { return current_arena().available_size(); }
+
+        void *malloc(uptr size_bytes) override {
+            return current_arena().malloc(size_bytes);
+        }
+
+        bool free(void *pointer) override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nFREE:: frame memory \n"
+                      << "- frame memory does not free space, use advance_frame() instead \n";
+#endif
+            return false;
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nPRINT:: frame memory \n- frame #" << _frame << " uses arena #"
+                      << _current << ", available size is " << available_size() << "\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            // every {Frames} shares the type id, but not the layout, so only identity is safe to test
+            return this == &other;
+        }
+    };
+}
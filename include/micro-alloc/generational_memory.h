@@ -0,0 +1,248 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "linear_memory.h"
+#include "traits.h"
+// <new> is a freestanding header, it is used for placement new
+#include <new>
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Generational Memory Resource:
+     *
+     * A ring of linear memory generations for cache like workloads, where objects expire
+     * by age. Every epoch opens a new generation, allocations are served by the generation
+     * of the newest epoch, and expiring an epoch drops it's whole generation at once.
+     * Objects that should outlive their generation can be promoted, i.e. copied forward
+     * into the newest generation.
+     *
+     * - Allocations are O(1)
+     * - Free does not do anything, generations are dropped with expire_oldest()/expire_before()
+     * - new_epoch() and expire_oldest() are O(1)
+     * - promote() is O(size of object)
+     *
+     * Notes:
+     * - Each generation gets an equal share of the memory
+     * - When all generations are alive, new_epoch() expires the oldest one
+     *
+     * @tparam Generations number of generations in the ring, >= 1
+     *
+     * @author Tomer Riko Shalev
+     */
+    template<unsigned Generations=4>
+    class generational_memory : public memory_resource {
+        static_assert(Generations > 0, "generational_memory requires at least one generation");
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::ptr_to_int;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        alignas(linear_memory) unsigned char _generations[Generations][sizeof(linear_memory)];
+        void *_ptr;
+        uptr _size;
+        uptr _generation_size;
+        unsigned _current;
+        unsigned _live;
+        uptr _epoch;
+
+        linear_memory &generation_at(unsigned index) {
+            return *reinterpret_cast<linear_memory *>(_generations[index]);
+        }
+        const linear_memory &generation_at(unsigned index) const {
+            return *reinterpret_cast<const linear_memory *>(_generations[index]);
+        }
+        unsigned oldest_index() const { return (_current + Generations - (_live - 1)) % Generations; }
+
+        /**
+         * index of the live generation, that holds {pointer}, or {Generations}
+         */
+        unsigned generation_of(const void *pointer) const {
+            const uptr address = ptr_to_int(pointer);
+            for (unsigned age = 0; age < _live; ++age) {
+                const unsigned index = (_current + Generations - age) % Generations;
+                const uptr start = ptr_to_int(_ptr) + index * _generation_size;
+                if (address >= start && address < start + _generation_size) return index;
+            }
+            return Generations;
+        }
+
+    public:
+        static constexpr unsigned generations_count() { return Generations; }
+
+        generational_memory() = delete;
+        generational_memory(const generational_memory &) = delete;
+        generational_memory &operator=(const generational_memory &) = delete;
+
+        /**
+         * ctor
+         *
+         * @param ptr start of memory
+         * @param size_bytes the memory size in bytes, it is split equally between the generations
+         * @param alignment power of 2 alignment
+         */
+        generational_memory(void *ptr, uptr size_bytes, uptr alignment = sizeof(uintptr_type)) :
+                base{12, alignment}, _ptr(ptr), _size(size_bytes),
+                _generation_size(size_bytes / Generations), _current(0), _live(1), _epoch(0) {
+            for (unsigned ix = 0; ix < Generations; ++ix) {
+                void *generation_ptr = base::int_to_ptr(ptr_to_int(ptr) + ix * _generation_size);
+                new(_generations[ix]) linear_memory(generation_ptr, _generation_size, alignment);
+            }
+            const bool is_memory_valid = is_alignment_pow_2() && generation_at(0).is_valid();
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: generational memory resource\n";
+            std::cout << "* generations count is " << Generations << std::endl;
+            std::cout << "* each generation is " << _generation_size << " bytes" << std::endl;
+            if (!is_memory_valid)
+                std::cout << "* error:: memory does not satisfy requirements !!!\n";
+#endif
+            if (!is_memory_valid) try_throw();
+        }
+
+        ~generational_memory() override {
+            for (unsigned ix = 0; ix < Generations; ++ix) generation_at(ix).~linear_memory();
+            _ptr = nullptr;
+            _size = 0;
+        }
+
+        /**
+         * the newest epoch, allocations go to it's generation
+         */
+        uptr epoch() const { return _epoch; }
+        uptr oldest_epoch() const { return _epoch - (_live - 1); }
+        unsigned live_generations() const { return _live; }
+
+        /**
+         * open a new generation for a new epoch, if all generations are alive,
+         * the oldest one is expired first
+         * @return the new epoch
+         */
+        uptr new_epoch() {
+            if (_live == Generations) expire_oldest();
+            _current = (_current + 1) % Generations;
+            generation_at(_current).reset();
+            _live += 1;
+            _epoch += 1;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nEPOCH:: generational memory\n- epoch #" << _epoch
+                      << " uses generation #" << _current << ", live generations " << _live << "\n";
+#endif
+            return _epoch;
+        }
+
+        /**
+         * drop the generation of the oldest epoch. If only the newest generation is alive,
+         * it is reset instead
+         */
+        void expire_oldest() {
+            const unsigned oldest = oldest_index();
+            generation_at(oldest).reset();
+            if (_live > 1) _live -= 1;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nEXPIRE:: generational memory\n- dropped generation #" << oldest
+                      << ", live generations " << _live << "\n";
+#endif
+        }
+
+        /**
+         * drop the generations of all epochs older than {epoch}
+         */
+        void expire_before(uptr epoch) {
+            while (_live > 1 && oldest_epoch() < epoch) expire_oldest();
+            if (_epoch < epoch) expire_oldest();
+        }
+
+        /**
+         * is {pointer} inside a live generation
+         */
+        bool is_alive(const void *pointer) const { return generation_of(pointer) != Generations; }
+
+        /**
+         * the epoch of the generation, that holds {pointer}
+         * @return {true} if pointer belongs to a live generation
+         */
+        bool epoch_of(const void *pointer, uptr &epoch) const {
+            const unsigned index = generation_of(pointer);
+            if (index == Generations) return false;
+            epoch = _epoch - (_current + Generations - index) % Generations;
+            return true;
+        }
+
+        /**
+         * copy a block forward into the newest generation
+         * @param pointer the block
+         * @param size_bytes size of the block
+         * @return the new block or {nullptr}, if {pointer} is already in the newest generation,
+         *         it is returned as is
+         */
+        void *promote(const void *pointer, uptr size_bytes) {
+            if (generation_of(pointer) == _current) return const_cast<void *>(pointer);
+            auto *destination = static_cast<unsigned char *>(malloc(size_bytes));
+            if (!destination) return nullptr;
+            const auto *source = static_cast<const unsigned char *>(pointer);
+            for (uptr ix = 0; ix < size_bytes; ++ix) destination[ix] = source[ix];
+            return destination;
+        }
+
+        /**
+         * move an object forward into the newest generation, the old object is destructed
+         * @tparam T object type
+         * @param object the object
+         * @return the new object or {nullptr}
+         */
+        template<class T>
+        T *promote(T *object) {
+            if (generation_of(object) == _current) return object;
+            void *destination = malloc(sizeof(T));
+            if (!destination) return nullptr;
+            T *promoted = new(destination) T(micro_alloc::traits::move(*object));
+            object->~T();
+            return promoted;
+        }
+
+        uptr available_size() const override { return generation_at(_current).available_size(); }
+
+        void *malloc(uptr size_bytes) override {
+            return generation_at(_current).malloc(size_bytes);
+        }
+
+        bool free(void *pointer) override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nFREE:: generational memory \n"
+                      << "- generational memory does not free space, expire epochs instead \n";
+#endif
+            return false;
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nPRINT:: generational memory \n- epochs [" << oldest_epoch() << "-" << _epoch
+                      << "], newest generation #" << _current << ", available size is "
+                      << available_size() << "\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            // every {Generations} shares the type id, but not the layout, so only identity is safe to test
+            return this == &other;
+        }
+    };
+}
@@ -0,0 +1,146 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+#include "stack_memory.h"
+#include "linear_memory.h"
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Inline Arena:
+     *
+     * Small buffer memory resource, that embeds an N bytes buffer inside the object itself,
+     * so it can live on the stack. The buffer is managed by a stack or linear memory, and once
+     * it is exhausted, allocations transparently overflow to an upstream memory resource.
+     *
+     * - Allocations and frees are the complexity of the inner memory while in the buffer,
+     *   and the complexity of the upstream memory after overflow.
+     *
+     * Notes:
+     * - Free resolves the owner of a pointer by address, so pointers of the buffer and of the
+     *   upstream may be freed in any order (the stack memory still requires LIFO for it's own blocks).
+     * - Requests, that might not fit in the buffer, go to the upstream.
+     * - Without an upstream ({nullptr}), allocations fail once the buffer is exhausted.
+     *
+     * @tparam N size in bytes of the inline buffer
+     * @tparam Memory the memory of the inline buffer, stack_memory or linear_memory
+     *
+     * @author Tomer Riko Shalev
+     */
+    template<unsigned N, class Memory=stack_memory>
+    class inline_arena : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::ptr_to_int;
+        using base::try_throw;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        alignas(2 * sizeof(uintptr_type)) unsigned char _buffer[N];
+        Memory _local;
+        memory_resource *_upstream;
+        uptr _overflow_count;
+
+        bool is_local(const void *pointer) const {
+            const uptr address = ptr_to_int(pointer);
+            return address >= ptr_to_int(_buffer) && address < ptr_to_int(_buffer) + N;
+        }
+
+        /**
+         * conservative test, that accounts for the block alignment and the footer of a stack memory
+         */
+        bool might_fit_locally(uptr size_bytes) const {
+            const uptr local_alignment = _local.alignment;
+            const uptr worst_case = align_up(size_bytes, local_alignment) + local_alignment + sizeof(uintptr_type);
+            return size_bytes && worst_case <= _local.available_size();
+        }
+
+    public:
+        inline_arena() = delete;
+        inline_arena(const inline_arena &) = delete;
+        inline_arena &operator=(const inline_arena &) = delete;
+
+        /**
+         * ctor
+         *
+         * @param upstream memory resource for overflow allocations, might be {nullptr}
+         * @param alignment power of 2 alignment of the inline buffer
+         */
+        explicit inline_arena(memory_resource *upstream, uptr alignment = sizeof(uintptr_type)) :
+                base{14, alignment}, _local(_buffer, N, alignment), _upstream(upstream), _overflow_count(0) {
+            this->_is_valid = _local.is_valid();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: inline arena of " << N << " bytes, "
+                      << (upstream ? "with" : "without") << " upstream memory\n";
+#endif
+        }
+
+        ~inline_arena() override {
+            _upstream = nullptr;
+        }
+
+        memory_resource *upstream() const { return _upstream; }
+        Memory &local_memory() { return _local; }
+        /**
+         * number of allocations, that were served by the upstream
+         */
+        uptr overflow_count() const { return _overflow_count; }
+        uptr available_size() const override { return _local.available_size(); }
+
+        void *malloc(uptr size_bytes) override {
+            if (might_fit_locally(size_bytes)) {
+                void *pointer = _local.malloc(size_bytes);
+                if (pointer) return pointer;
+            }
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nMALLOC:: inline arena\n- " << size_bytes
+                      << " bytes do not fit in the inline buffer, overflow to upstream\n";
+#endif
+            if (!_upstream) {
+                try_throw();
+                return nullptr;
+            }
+            void *pointer = _upstream->malloc(size_bytes);
+            if (pointer) _overflow_count += 1;
+            return pointer;
+        }
+
+        bool free(void *pointer) override {
+            if (is_local(pointer)) return _local.free(pointer);
+            if (!_upstream) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "\nFREE:: inline arena\n- error: address is not in the inline buffer\n";
+#endif
+                try_throw();
+                return false;
+            }
+            return _upstream->free(pointer);
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nPRINT:: inline arena\n- inline buffer available size is " << available_size()
+                      << "/" << N << ", overflow allocations " << _overflow_count << "\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+}
@@ -0,0 +1,286 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "pool_memory.h"
+// <new> is a freestanding header, it is used for placement new
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define MICRO_ALLOC_HAS_MMAP
+#endif
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * IO Buffer Pool:
+     *
+     * Page aligned, size classed buffers for O_DIRECT and registered (fixed) buffers I/O,
+     * like io_uring_register_buffers. The memory is usually a big mmap'd region, that is split
+     * into contiguous slabs, one per size class, and every slab is a pool memory of page aligned
+     * buffers. Because slabs are contiguous, the whole pool can be exposed as iovecs, either one
+     * per size class or one per buffer, and every buffer can be mapped back to it's registration slot.
+     *
+     * - Allocations are O(size-classes)
+     * - Free is O(size-classes)
+     *
+     * Notes:
+     * - Buffer sizes are aligned up to the page size, and buffers are page aligned
+     * - Allocations are served by the smallest class, that fits and has a free buffer
+     * - The free list links of the pools are written into the free buffers themselves
+     *
+     * @tparam MaxClasses max number of size classes
+     *
+     * @author Tomer Riko Shalev
+     */
+    template<unsigned MaxClasses=8>
+    class io_buffer_pool : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::align_down;
+        using base::ptr_to_int;
+        using base::int_to_ptr;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using base::max;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        alignas(pool_memory) unsigned char _pools[MaxClasses][sizeof(pool_memory)];
+        uptr _class_start[MaxClasses];
+        uptr _class_end[MaxClasses];
+        unsigned _classes;
+        void *_ptr;
+        uptr _size;
+        uptr _carve_head;
+        uptr _carve_end;
+
+        pool_memory &pool_at(unsigned index) {
+            return *reinterpret_cast<pool_memory *>(_pools[index]);
+        }
+        const pool_memory &pool_at(unsigned index) const {
+            return *reinterpret_cast<const pool_memory *>(_pools[index]);
+        }
+
+    public:
+        static constexpr unsigned invalid_slot = ~0u;
+
+        io_buffer_pool() = delete;
+        io_buffer_pool(const io_buffer_pool &) = delete;
+        io_buffer_pool &operator=(const io_buffer_pool &) = delete;
+
+        /**
+         * ctor
+         *
+         * @param ptr start of memory, usually a page aligned mmap'd region, see map_region()
+         * @param size_bytes the memory size in bytes
+         * @param page_size page size, a power of 2
+         */
+        io_buffer_pool(void *ptr, uptr size_bytes, uptr page_size = 4096) :
+                base{15, page_size}, _classes(0), _ptr(ptr), _size(size_bytes), _carve_head(0), _carve_end(0) {
+            const bool is_memory_valid_1 = is_alignment_pow_2();
+            if (is_memory_valid_1) {
+                _carve_head = align_up(ptr_to_int(ptr));
+                _carve_end = align_down(ptr_to_int(ptr) + size_bytes);
+            }
+            const bool is_memory_valid_2 = _carve_end > _carve_head;
+            const bool is_memory_valid = is_memory_valid_1 and is_memory_valid_2;
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: io buffer pool\n";
+            std::cout << "* page size is " << page_size << " bytes" << std::endl;
+            std::cout << "* page aligned memory is " << _carve_end - _carve_head << " bytes" << std::endl;
+            if (!is_memory_valid_1)
+                std::cout << "* error:: page size should be a power of 2\n";
+            if (!is_memory_valid_2)
+                std::cout << "* error:: memory does not contain a single page !!!\n";
+#endif
+            if (!is_memory_valid) try_throw();
+        }
+
+        ~io_buffer_pool() override {
+            for (unsigned ix = 0; ix < _classes; ++ix) pool_at(ix).~pool_memory();
+            _classes = 0;
+            _ptr = nullptr;
+            _size = 0;
+        }
+
+        /**
+         * carve a new size class out of the remaining memory
+         *
+         * @param buffer_size size of buffers, aligned up to the page size
+         * @param count number of buffers
+         * @return {true} on success
+         */
+        bool add_class(uptr buffer_size, uptr count) {
+            buffer_size = align_up(buffer_size);
+            const uptr slab_size = buffer_size * count;
+            const bool is_possible = this->_is_valid && _classes < MaxClasses && count &&
+                                     buffer_size && _carve_head + slab_size <= _carve_end;
+            if (!is_possible) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "\nADD CLASS:: io buffer pool\n- error, no room for " << count
+                          << " buffers of " << buffer_size << " bytes\n";
+#endif
+                try_throw();
+                return false;
+            }
+            new(_pools[_classes]) pool_memory(int_to_ptr(_carve_head), slab_size, buffer_size, this->alignment);
+            _class_start[_classes] = _carve_head;
+            _class_end[_classes] = _carve_head + slab_size;
+            _carve_head += slab_size;
+            _classes += 1;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nADD CLASS:: io buffer pool\n- class #" << _classes - 1 << " of " << count
+                      << " buffers of " << buffer_size << " bytes\n";
+#endif
+            return true;
+        }
+
+        unsigned classes_count() const { return _classes; }
+        uptr class_buffer_size(unsigned index) const { return pool_at(index).block_size(); }
+        uptr class_buffers_count(unsigned index) const { return pool_at(index).blocks_count(); }
+        uptr class_free_buffers_count(unsigned index) const { return pool_at(index).free_blocks_count(); }
+
+        /**
+         * size class of a buffer, or {invalid_slot}
+         */
+        unsigned class_of(const void *pointer) const {
+            const uptr address = ptr_to_int(pointer);
+            for (unsigned ix = 0; ix < _classes; ++ix)
+                if (address >= _class_start[ix] && address < _class_end[ix]) return ix;
+            return invalid_slot;
+        }
+
+        /**
+         * number of iovecs, that fill_iovecs() writes
+         */
+        uptr iovecs_count(bool per_buffer = false) const {
+            if (!per_buffer) return _classes;
+            uptr count = 0;
+            for (unsigned ix = 0; ix < _classes; ++ix) count += class_buffers_count(ix);
+            return count;
+        }
+
+        /**
+         * write the layout of the pool as iovecs, for example for io_uring_register_buffers
+         *
+         * @tparam IOVec a type with iov_base and iov_len members, like struct iovec
+         * @param out array of at least {max_count} iovecs
+         * @param max_count capacity of out
+         * @param per_buffer if {true}, one iovec per buffer, otherwise one per size class
+         * @return number of iovecs written
+         */
+        template<class IOVec>
+        uptr fill_iovecs(IOVec *out, uptr max_count, bool per_buffer = false) const {
+            uptr count = 0;
+            for (unsigned ix = 0; ix < _classes; ++ix) {
+                const uptr step = per_buffer ? class_buffer_size(ix) : _class_end[ix] - _class_start[ix];
+                for (uptr address = _class_start[ix]; address < _class_end[ix] && count < max_count;
+                     address += step, ++count) {
+                    out[count].iov_base = int_to_ptr(address);
+                    out[count].iov_len = step;
+                }
+            }
+            return count;
+        }
+
+        /**
+         * registration slot (index in the iovecs of fill_iovecs()) of a buffer, or {invalid_slot}
+         */
+        unsigned registration_slot(const void *pointer, bool per_buffer = false) const {
+            const unsigned index = class_of(pointer);
+            if (index == invalid_slot || !per_buffer) return index;
+            uptr slot = 0;
+            for (unsigned ix = 0; ix < index; ++ix) slot += class_buffers_count(ix);
+            slot += (ptr_to_int(pointer) - _class_start[index]) / class_buffer_size(index);
+            return unsigned(slot);
+        }
+
+        uptr available_size() const override {
+            uptr size = 0;
+            for (unsigned ix = 0; ix < _classes; ++ix) size += pool_at(ix).available_size();
+            return size;
+        }
+
+        void *malloc(uptr size_bytes) override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nMALLOC:: io buffer pool\n- requested " << size_bytes << " bytes\n";
+#endif
+            unsigned best = invalid_slot;
+            for (unsigned ix = 0; ix < _classes; ++ix) {
+                const bool fits = size_bytes <= class_buffer_size(ix) && class_free_buffers_count(ix);
+                if (fits && (best == invalid_slot || class_buffer_size(ix) < class_buffer_size(best)))
+                    best = ix;
+            }
+            if (best == invalid_slot) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error, no free buffer fits the request\n";
+#endif
+                try_throw();
+                return nullptr;
+            }
+            return pool_at(best).malloc();
+        }
+
+        bool free(void *pointer) override {
+            const unsigned index = class_of(pointer);
+            if (index == invalid_slot) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "\nFREE:: io buffer pool\n- error: address is not of a buffer in the pool\n";
+#endif
+                try_throw();
+                return false;
+            }
+            return pool_at(index).free(pointer);
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nPRINT:: io buffer pool\n";
+            for (unsigned ix = 0; ix < _classes; ++ix)
+                std::cout << "- class #" << ix << " of " << class_buffer_size(ix) << " bytes buffers ["
+                          << class_free_buffers_count(ix) << "/" << class_buffers_count(ix) << "] free\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            // every {MaxClasses} shares the type id, but not the layout, so only identity is safe to test
+            return this == &other;
+        }
+
+#ifdef MICRO_ALLOC_HAS_MMAP
+        /**
+         * map an anonymous, private and page aligned region, that can back the pool
+         * @return the region or {nullptr}
+         */
+        static void *map_region(uptr size_bytes) {
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE;
+#endif
+            void *region = ::mmap(nullptr, size_bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+            return region == MAP_FAILED ? nullptr : region;
+        }
+
+        static void unmap_region(void *region, uptr size_bytes) {
+            if (region) ::munmap(region, size_bytes);
+        }
+#endif
+    };
+}
@@ -45,7 +45,8 @@ namespace micro_alloc {
 
         void *_ptr;
         void *_current_ptr;
-        uint _size;
+        void *_last_ptr;
+        uptr _size;
 
     public:
 
@@ -58,7 +59,7 @@ namespace micro_alloc {
          * @param alignment power of 2 alignment
          */
         linear_memory(void *ptr, uptr size_bytes, uptr alignment = sizeof(uintptr_type)) :
-                base{1, alignment}, _ptr(ptr), _current_ptr(nullptr), _size(size_bytes) {
+                base{1, alignment}, _ptr(ptr), _current_ptr(nullptr), _last_ptr(nullptr), _size(size_bytes) {
             const bool is_memory_valid = is_alignment_pow_2();
             this->_is_valid = is_memory_valid;
 
@@ -74,12 +75,13 @@ namespace micro_alloc {
         }
 
         ~linear_memory() override {
-            _current_ptr = _ptr = nullptr;
+            _current_ptr = _last_ptr = _ptr = nullptr;
             _size = 0;
         }
 
         void reset() {
             _current_ptr = base::template int_to<void *>(align_up(ptr_to_int(_ptr)));
+            _last_ptr = nullptr;
 #ifdef MICRO_ALLOC_DEBUG
             std::cout << "\nRESET:: linear memory\n- reset memory to start @ "
                       << ptr_to_int(_current_ptr) << " (aligned up)\n";
@@ -122,9 +124,27 @@ namespace micro_alloc {
             }
             auto *pointer = _current_ptr;
             _current_ptr = base::template int_to<void *>(ptr_to_int(pointer) + size_bytes);
+            _last_ptr = pointer;
             return pointer;
         }
 
+        /**
+         * only the latest allocated block can grow or shrink in place
+         */
+        bool expand(void *pointer, uptr size_bytes) override {
+            size_bytes = align_up(size_bytes);
+            const bool is_last = pointer != nullptr && pointer == _last_ptr;
+            const bool has_space = size_bytes && ptr_to_int(pointer) + size_bytes <= end_aligned_address();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nEXPAND:: linear allocator\n- request to resize block @" << ptr_to_int(pointer)
+                      << " to " << size_bytes << " bytes (aligned up), "
+                      << (is_last && has_space ? "success\n" : "failure\n");
+#endif
+            if (!is_last || !has_space) return false;
+            _current_ptr = base::template int_to<void *>(ptr_to_int(pointer) + size_bytes);
+            return true;
+        }
+
         bool free(void *pointer) override {
 #ifdef MICRO_ALLOC_DEBUG
             std::cout << "\nFREE:: linear allocator \n"
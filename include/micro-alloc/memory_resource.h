@@ -102,6 +102,14 @@ namespace micro_alloc {
          */
         virtual bool free(void *pointer) = 0;
 
+        /**
+         * try to grow or shrink an allocated block in place, without moving it
+         * @param pointer pointer of an allocated block
+         * @param size_bytes the new size in bytes
+         * @return {true} if the block now holds at least {size_bytes} bytes, {false} if it was not changed
+         */
+        virtual bool expand(void * /*pointer*/, uptr /*size_bytes*/) { return false; }
+
         /**
          * get the available size in bytes in this memory resource
          */
@@ -122,8 +130,13 @@ namespace micro_alloc {
 
     };
 
-    bool operator==(const memory_resource &a,
+    inline bool operator==(const memory_resource &a,
                     const memory_resource &b) noexcept {
         return &a == &b || a.is_equal(b);
     }
+
+    inline bool operator!=(const memory_resource &a,
+                           const memory_resource &b) noexcept {
+        return !(a == b);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,215 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+#include "std_memory.h"
+#include "traits.h"
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    namespace detail {
+
+        /**
+         * upstream memory of the slabs of all the node pools of a bank
+         */
+        template<unsigned BANK>
+        struct node_pool_bank {
+            static memory_resource *&upstream() {
+                static std_memory default_upstream;
+                static memory_resource *upstream = &default_upstream;
+                return upstream;
+            }
+        };
+
+        /**
+         * pool of fixed size blocks, that grows by slabs from the upstream of it's bank,
+         * one static instance exists for every (BlockSize, BANK) pair
+         *
+         * Slab is:
+         *  [ next slab | ..aligned blocks.. ]
+         */
+        template<uintptr_type BlockSize, uintptr_type Alignment, unsigned BANK>
+        class node_pool {
+        private:
+            struct free_block_t { free_block_t *next; };
+            struct slab_t { slab_t *next; };
+
+            static constexpr uintptr_type blocks_per_slab = 4096 / BlockSize > 16 ? 4096 / BlockSize : 16;
+            static constexpr uintptr_type slab_size = sizeof(slab_t) + Alignment - 1 + blocks_per_slab * BlockSize;
+
+            free_block_t *_free_list = nullptr;
+            slab_t *_slabs = nullptr;
+            uintptr_type _blocks_count = 0;
+            uintptr_type _free_blocks_count = 0;
+
+            node_pool() = default;
+
+            static char *blocks_of(slab_t *slab) {
+                const uintptr_type address = reinterpret_cast<uintptr_type>(slab + 1);
+                return reinterpret_cast<char *>((address + Alignment - 1) & ~(Alignment - 1));
+            }
+
+            bool grow() {
+                auto *slab = static_cast<slab_t *>(node_pool_bank<BANK>::upstream()->malloc(slab_size));
+                if (!slab) return false;
+                slab->next = _slabs;
+                _slabs = slab;
+                char *blocks = blocks_of(slab);
+                // blocks are pushed in reverse, so they are handed in address order
+                for (uintptr_type ix = blocks_per_slab; ix > 0; --ix) {
+                    auto *block = reinterpret_cast<free_block_t *>(blocks + (ix - 1) * BlockSize);
+                    block->next = _free_list;
+                    _free_list = block;
+                }
+                _blocks_count += blocks_per_slab;
+                _free_blocks_count += blocks_per_slab;
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "\nGROW:: node pool of " << BlockSize << " bytes blocks\n- "
+                          << _blocks_count << " blocks\n";
+#endif
+                return true;
+            }
+
+        public:
+            node_pool(const node_pool &) = delete;
+            node_pool &operator=(const node_pool &) = delete;
+
+            static node_pool &instance() {
+                static node_pool pool;
+                return pool;
+            }
+
+            static constexpr uintptr_type block_size() { return BlockSize; }
+            uintptr_type blocks_count() const { return _blocks_count; }
+            uintptr_type free_blocks_count() const { return _free_blocks_count; }
+
+            void *allocate() {
+                if (!_free_list && !grow()) return nullptr;
+                free_block_t *block = _free_list;
+                _free_list = block->next;
+                _free_blocks_count -= 1;
+                return block;
+            }
+
+            void deallocate(void *pointer) {
+                auto *block = static_cast<free_block_t *>(pointer);
+                block->next = _free_list;
+                _free_list = block;
+                _free_blocks_count += 1;
+            }
+
+            /**
+             * is {pointer} a block of this pool, O(slabs)
+             */
+            bool owns(const void *pointer) const {
+                const char *p = static_cast<const char *>(pointer);
+                for (slab_t *slab = _slabs; slab; slab = slab->next) {
+                    const char *blocks = blocks_of(slab);
+                    if (p >= blocks && p < blocks + blocks_per_slab * BlockSize) return true;
+                }
+                return false;
+            }
+        };
+    }
+
+    /**
+     * Node Pool Allocator:
+     *
+     * Allocator for node based containers (std::list, std::map, std::unordered_map etc..). Containers
+     * rebind their allocator to an internal node type, which the user can not size a pool for. Every
+     * rebind of this allocator looks up a static pool, that is shared by all the types with the same
+     * block size (sizeof the type, rounded up to it's alignment), and is created on first use.
+     * Pools grow by slabs, that are taken from the upstream memory of the bank (std_memory by default).
+     *
+     * - Single object allocations and deallocations are O(1)
+     * - Array allocations (n > 1, like the buckets of unordered_map) go straight to the upstream
+     *
+     * Notes:
+     * - All the instances with the same BANK are equal, so containers move and swap by stealing pointers
+     * - Slabs are kept for the lifetime of the program, freed nodes are recycled by the same size class
+     * - deallocate(p) without a count searches the slabs of the pool to tell nodes from arrays
+     * - Not thread safe, use different banks for different threads
+     *
+     * @tparam T value type
+     * @tparam BANK the bank number, banks have separate pools and upstreams
+     */
+    template<typename T=unsigned char, unsigned BANK=0>
+    class node_pool_allocator {
+    private:
+        using uptr = uintptr_type;
+        static constexpr uptr alignment = alignof(T) > sizeof(void *) ? alignof(T) : sizeof(void *);
+        static constexpr uptr block_size =
+                ((sizeof(T) > sizeof(void *) ? sizeof(T) : sizeof(void *)) + alignment - 1) & ~(alignment - 1);
+
+    public:
+        using value_type = T;
+        using size_t = unsigned long;
+        using size_type = size_t;
+        using pool_type = detail::node_pool<block_size, alignment, BANK>;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::true_type;
+
+        template<class U>
+        node_pool_allocator(const node_pool_allocator<U, BANK> &) noexcept {}
+        node_pool_allocator() = default;
+
+        /**
+         * set the upstream memory of the slabs of every pool of this bank, set it before the first allocation
+         */
+        static void set_upstream(memory_resource *upstream) { detail::node_pool_bank<BANK>::upstream() = upstream; }
+
+        /**
+         * the pool of this type
+         */
+        static pool_type &pool() { return pool_type::instance(); }
+
+        template<class U, class... Args>
+        void construct(U *p, Args &&... args) {
+            ::new(p) U(micro_alloc::traits::forward<Args>(args)...);
+        }
+
+        template<class U> void destroy(U *p) { p->~U(); }
+
+        T *allocate(size_t n) {
+            if (n == 1) return static_cast<T *>(pool().allocate());
+            return static_cast<T *>(detail::node_pool_bank<BANK>::upstream()->malloc(n * sizeof(T)));
+        }
+
+        /**
+         * @param n the count, that was allocated, or 0 if it is not known
+         */
+        void deallocate(T *p, size_t n = 0) {
+            if (n == 1 || (n == 0 && pool().owns(p))) pool().deallocate(p);
+            else detail::node_pool_bank<BANK>::upstream()->free(p);
+        }
+
+        template<class U> struct rebind {
+            typedef node_pool_allocator<U, BANK> other;
+        };
+    };
+
+    template<class T1, class T2, unsigned BANK>
+    bool operator==(const node_pool_allocator<T1, BANK> &lhs, const node_pool_allocator<T2, BANK> &rhs) noexcept {
+        return true;
+    }
+
+    template<class T1, class T2, unsigned BANK>
+    bool operator!=(const node_pool_allocator<T1, BANK> &lhs, const node_pool_allocator<T2, BANK> &rhs) noexcept {
+        return false;
+    }
+}
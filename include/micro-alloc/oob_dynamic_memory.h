@@ -0,0 +1,345 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Out Of Band Dynamic Memory Resource:
+     *
+     * Best-fit dynamic memory allocator with blocks coalescing, that NEVER reads or writes
+     * the memory it manages. All of the book-keeping lives in a separate metadata buffer,
+     * and the allocator operates on offsets relative to a base address. This makes it
+     * suitable for device-mapped, read-only-mapped memory and for sub-allocating file or
+     * buffer offsets, where there is no memory at all (use a {nullptr} base).
+     *
+     * Allocation is O(free-list-size)
+     * Free is:
+     * - O(1) for coalescing and bookkeeping, because neighbors are linked in address order,
+     * - O(blocks-count) to resolve the block of an offset.
+     *
+     * Notes:
+     * - The metadata buffer is carved into nodes, each node describes one block (free or
+     *   allocated). Use metadata_size_for(max_blocks) to size it.
+     * - When there are no spare nodes, a free block is handed whole instead of being split,
+     *   so running low on nodes costs some internal fragmentation and never fails an allocation.
+     * - Offsets are relative to {base}, and are aligned, such that {base + offset} is aligned.
+     * - malloc()/free() with pointers require a real base, for pure offsets use
+     *   malloc_offset()/free_offset().
+     *
+     * @author Tomer Riko Shalev
+     */
+    class oob_dynamic_memory : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::align_down;
+        using base::is_aligned;
+        using base::ptr_to_int;
+        using base::int_to_ptr;
+        using base::int_to;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using base::max;
+        using uintptr_type = memory_resource::uintptr_type;
+
+    public:
+        struct node_t {
+            uptr offset = 0;
+            uptr size = 0;
+            bool allocated = false;
+            // neighbor blocks in address order
+            node_t *prev = nullptr;
+            node_t *next = nullptr;
+            // free list links
+            node_t *free_prev = nullptr;
+            node_t *free_next = nullptr;
+        };
+        static constexpr uptr invalid_offset = ~uptr(0);
+
+        /**
+         * size in bytes of a metadata buffer, that can describe {max_blocks} blocks
+         */
+        static constexpr uptr metadata_size_for(uptr max_blocks) {
+            return max_blocks * sizeof(node_t) + sizeof(uintptr_type);
+        }
+
+    private:
+        void *_base;
+        uptr _size;
+        void *_metadata;
+        uptr _metadata_size;
+        uptr _start_offset;
+        uptr _end_offset;
+        uptr _allocations;
+        node_t *_blocks;
+        node_t *_free_list_root;
+        node_t *_spare_nodes;
+        uptr _spare_nodes_count;
+
+        node_t *acquire_node() {
+            if (!_spare_nodes) return nullptr;
+            node_t *node = _spare_nodes;
+            _spare_nodes = node->next;
+            _spare_nodes_count -= 1;
+            *node = node_t();
+            return node;
+        }
+
+        void release_node(node_t *node) {
+            node->next = _spare_nodes;
+            _spare_nodes = node;
+            _spare_nodes_count += 1;
+        }
+
+        void push_free(node_t *node) {
+            node->free_prev = nullptr;
+            node->free_next = _free_list_root;
+            if (_free_list_root) _free_list_root->free_prev = node;
+            _free_list_root = node;
+        }
+
+        void remove_free(node_t *node) {
+            if (node->free_prev) node->free_prev->free_next = node->free_next;
+            else _free_list_root = node->free_next;
+            if (node->free_next) node->free_next->free_prev = node->free_prev;
+            node->free_prev = node->free_next = nullptr;
+        }
+
+        // unlink {node} from the address list, it's neighbor takes it's range
+        void remove_block(node_t *node) {
+            if (node->prev) node->prev->next = node->next;
+            else _blocks = node->next;
+            if (node->next) node->next->prev = node->prev;
+            release_node(node);
+        }
+
+        node_t *find_allocated_block(uptr offset) const {
+            node_t *node = _blocks;
+            while (node && node->offset < offset) node = node->next;
+            const bool found = node && node->offset == offset && node->allocated;
+            return found ? node : nullptr;
+        }
+
+    public:
+        uptr available_size() const override {
+            return (_end_offset - _start_offset) - _allocations;
+        }
+        uptr start_offset() const { return _start_offset; }
+        uptr end_offset() const { return _end_offset; }
+        uptr spare_nodes_count() const { return _spare_nodes_count; }
+        void *offset_to_ptr(uptr offset) const { return int_to_ptr(ptr_to_int(_base) + offset); }
+        uptr ptr_to_offset(const void *pointer) const { return ptr_to_int(pointer) - ptr_to_int(_base); }
+
+        oob_dynamic_memory() = delete;
+
+        /**
+         * ctor
+         *
+         * @param ptr base address of the managed range, might be {nullptr} for pure offsets.
+         *             The memory is never touched.
+         * @param size_bytes size of the managed range in bytes
+         * @param metadata memory for the book-keeping nodes
+         * @param metadata_size_bytes size of metadata in bytes, see metadata_size_for()
+         * @param alignment alignment has to be a power of 2
+         */
+        oob_dynamic_memory(void *ptr, uptr size_bytes, void *metadata, uptr metadata_size_bytes,
+                           uptr alignment = sizeof(uintptr_type)) :
+                base{8, alignment}, _base(ptr), _size(size_bytes), _metadata(metadata),
+                _metadata_size(metadata_size_bytes), _start_offset(0), _end_offset(0),
+                _allocations(0), _blocks(nullptr), _free_list_root(nullptr),
+                _spare_nodes(nullptr), _spare_nodes_count(0) {
+            const bool is_memory_valid_1 = is_alignment_pow_2();
+            if (is_memory_valid_1) reset();
+            const bool is_memory_valid_2 = _blocks != nullptr;
+            const bool is_memory_valid = is_memory_valid_1 and is_memory_valid_2;
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: out of band dynamic memory resource\n";
+            std::cout << "* requested alignment is " << alignment << " bytes" << std::endl;
+            std::cout << "* managed range is [" << _start_offset << "-" << _end_offset << "] offsets\n";
+            std::cout << "* metadata can describe " << _spare_nodes_count + (_blocks ? 1 : 0)
+                      << " blocks" << std::endl;
+            if (!is_memory_valid_1)
+                std::cout << "* error:: alignment should be a power of 2\n";
+            if (!is_memory_valid_2)
+                std::cout << "* error:: range or metadata do not satisfy minimal size requirements !!!\n";
+#endif
+            if (!is_memory_valid) try_throw();
+        }
+
+        ~oob_dynamic_memory() override {
+            _blocks = _free_list_root = _spare_nodes = nullptr;
+            _base = _metadata = nullptr;
+            _allocations = _size = _metadata_size = 0;
+            this->_is_valid = false;
+        }
+
+        /**
+         * free all blocks at once
+         */
+        void reset() {
+            _blocks = _free_list_root = _spare_nodes = nullptr;
+            _spare_nodes_count = _allocations = 0;
+            const uptr base_address = ptr_to_int(_base);
+            _start_offset = align_up(base_address) - base_address;
+            _end_offset = align_down(base_address + _size) - base_address;
+            if (_end_offset <= _start_offset) return;
+            const uptr nodes_start = align_up(ptr_to_int(_metadata), sizeof(uintptr_type));
+            const uptr nodes_end = ptr_to_int(_metadata) + _metadata_size;
+            if (nodes_end <= nodes_start) return;
+            const uptr nodes_count = (nodes_end - nodes_start) / sizeof(node_t);
+            auto *nodes = int_to<node_t *>(nodes_start);
+            for (uptr ix = nodes_count; ix > 0; --ix) release_node(&nodes[ix - 1]);
+            node_t *root = acquire_node();
+            if (!root) return;
+            root->offset = _start_offset;
+            root->size = _end_offset - _start_offset;
+            _blocks = root;
+            push_free(root);
+        }
+
+        /**
+         * allocate a range
+         * @param size_bytes size of range in bytes
+         * @return the offset of the range or {invalid_offset}
+         */
+        uptr malloc_offset(uptr size_bytes) {
+            size_bytes = align_up(size_bytes);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nMALLOC:: out of band dynamic allocator \n- requested block size is "
+                      << size_bytes << " bytes (aligned up)" << std::endl;
+#endif
+            node_t *best_node = nullptr;
+            if (size_bytes) {
+                for (node_t *node = _free_list_root; node; node = node->free_next) {
+                    const bool fits = size_bytes <= node->size;
+                    if (fits && (best_node == nullptr || node->size < best_node->size))
+                        best_node = node;
+                }
+            }
+            if (!best_node) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- search failure:: no block was found" << std::endl;
+#endif
+                try_throw();
+                return invalid_offset;
+            }
+
+            // split, the right part stays free. The remainder is always aligned, because
+            // sizes and offsets are aligned
+            const bool has_remainder = best_node->size > size_bytes;
+            node_t *right = has_remainder ? acquire_node() : nullptr;
+            if (right) {
+                right->offset = best_node->offset + size_bytes;
+                right->size = best_node->size - size_bytes;
+                right->prev = best_node;
+                right->next = best_node->next;
+                if (best_node->next) best_node->next->prev = right;
+                best_node->next = right;
+                best_node->size = size_bytes;
+                push_free(right);
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- split:: into two blocks of sizes [" << best_node->size << ":"
+                          << right->size << "]" << std::endl;
+#endif
+            }
+            remove_free(best_node);
+            best_node->allocated = true;
+            _allocations += best_node->size;
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "- fulfilled:: block of size " << best_node->size
+                      << " bytes @ offset " << best_node->offset << std::endl;
+            print(true);
+#endif
+            return best_node->offset;
+        }
+
+        /**
+         * free an allocated range
+         * @param offset the offset, that was returned by malloc_offset()
+         * @return {true/false} on success/failure
+         */
+        bool free_offset(uptr offset) {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << std::endl << "FREE:: out of band dynamic allocator\n- offset @ " << offset << "\n";
+#endif
+            node_t *node = find_allocated_block(offset);
+            if (!node) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error: offset is not of an allocated block\n";
+#endif
+                try_throw();
+                return false;
+            }
+            node->allocated = false;
+            _allocations -= node->size;
+
+            // coalesce right, right neighbor is swallowed
+            node_t *right = node->next;
+            if (right && !right->allocated) {
+                node->size += right->size;
+                remove_free(right);
+                remove_block(right);
+            }
+            // coalesce left, we are swallowed by our left neighbor, which is already listed as free
+            node_t *left = node->prev;
+            if (left && !left->allocated) {
+                left->size += node->size;
+                remove_block(node);
+            } else push_free(node);
+#ifdef MICRO_ALLOC_DEBUG
+            print(true);
+#endif
+            return true;
+        }
+
+        void *malloc(uptr size_bytes) override {
+            const uptr offset = malloc_offset(size_bytes);
+            return offset == invalid_offset ? nullptr : offset_to_ptr(offset);
+        }
+
+        bool free(void *pointer) override {
+            return free_offset(ptr_to_offset(pointer));
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            if (!embed)
+                std::cout << std::endl << "PRINT:: out of band dynamic allocator " << std::endl;
+            std::cout << "- blocks [";
+            for (node_t *node = _blocks; node; node = node->next) {
+                std::cout << node->size << (node->allocated ? "(A)" : "(F)")
+                          << (node->next ? "->" : "");
+            }
+            std::cout << "]" << std::endl << "- available size [" << available_size() << "/"
+                      << _end_offset - _start_offset << "], spare nodes " << _spare_nodes_count
+                      << std::endl;
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            bool equals = this->type_id() == other.type_id();
+            if (!equals) return false;
+            const auto *casted_other = static_cast<const oob_dynamic_memory *>(&other);
+            equals = this->_base == casted_other->_base && this->_metadata == casted_other->_metadata;
+            return equals;
+        }
+    };
+}
@@ -0,0 +1,155 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+// unlike the rest of the library, this header requires the standard library for threads
+#include "utils.h"
+#include <thread>
+
+namespace micro_alloc {
+
+    /**
+     * Executor, that runs the tasks of a parallel operation on freshly spawned threads,
+     * the calling thread runs the first task. Any type with the same two methods can be
+     * used instead, for example an adaptor of an existing thread pool.
+     */
+    class thread_executor {
+    private:
+        unsigned _concurrency;
+
+    public:
+        /**
+         * @param concurrency max number of tasks, 0 for the number of hardware threads
+         */
+        explicit thread_executor(unsigned concurrency = 0) :
+                _concurrency(concurrency ? concurrency : std::thread::hardware_concurrency()) {
+            if (_concurrency == 0) _concurrency = 1;
+        }
+
+        unsigned concurrency() const { return _concurrency; }
+
+        /**
+         * run task(0) .. task(tasks-1) and wait for all of them
+         */
+        template<class Task>
+        void run(unsigned tasks, const Task &task) const {
+            if (tasks == 0) return;
+            std::thread *threads = tasks > 1 ? new std::thread[tasks - 1] : nullptr;
+            for (unsigned ix = 1; ix < tasks; ++ix)
+                threads[ix - 1] = std::thread([&task, ix]() { task(ix); });
+            task(0);
+            for (unsigned ix = 1; ix < tasks; ++ix) threads[ix - 1].join();
+            delete[] threads;
+        }
+    };
+
+    namespace detail {
+
+        /**
+         * split [0, count) elements at {first} into at most {tasks} chunks, that start at page
+         * boundaries, and run {fn(chunk_first, chunk_count)} for every chunk on the executor
+         */
+        template<class U, class Executor, class Fn>
+        void parallel_for_pages(U *first, uintptr_type count, Executor &executor,
+                                uintptr_type page_size, uintptr_type min_chunk_bytes, const Fn &fn) {
+            const uintptr_type total_bytes = count * sizeof(U);
+            uintptr_type tasks = executor.concurrency();
+            if (min_chunk_bytes && total_bytes / min_chunk_bytes < tasks) tasks = total_bytes / min_chunk_bytes;
+            if (tasks <= 1) {
+                fn(first, count);
+                return;
+            }
+            const uintptr_type base = reinterpret_cast<uintptr_type>(first);
+            const uintptr_type chunk_bytes = total_bytes / tasks;
+            // the index of the first element, that starts at or after the page boundary of a chunk
+            auto boundary = [=](uintptr_type task) -> uintptr_type {
+                if (task == 0) return 0;
+                if (task >= tasks) return count;
+                const uintptr_type address = (base + task * chunk_bytes + page_size - 1) & ~(page_size - 1);
+                const uintptr_type index = (address - base + sizeof(U) - 1) / sizeof(U);
+                return index < count ? index : count;
+            };
+            executor.run(unsigned(tasks), [&](unsigned task) {
+                const uintptr_type from = boundary(task), to = boundary(task + 1);
+                if (to > from) fn(first + from, to - from);
+            });
+        }
+    }
+
+    /**
+     * Allocate and Construct a huge array in parallel, like new_array.
+     * Construction is split into page aligned chunks, that are constructed by the tasks of an
+     * executor, so pages are first touched by the threads, that construct them, which spreads
+     * page placement across memory controllers on NUMA systems.
+     * NOTE:
+     * - The layout is the same as new_array, release the array with delete_array or parallel_delete_array
+     * - Constructors must not throw
+     *
+     * @tparam U value type
+     * @tparam allocator_type allocator type
+     * @tparam Executor executor type, see thread_executor
+     * @tparam Args args for constructor
+     * @param count how many objects in array
+     * @param allocator allocator instance
+     * @param executor executor of the construction tasks
+     * @param args variadic args for constructor, they are shared by all the tasks
+     * @return a pointer to initialized array
+     */
+    template<class U, class allocator_type, class Executor, class... Args>
+    U * parallel_new_array(const uintptr_type count,
+                           const allocator_type & allocator,
+                           Executor && executor,
+                           const Args &... args) {
+        using rebind_allocator_t = typename allocator_type::template rebind<char>::other;
+        rebind_allocator_t rebind_allocator(allocator);
+        constexpr auto header_size = detail::array_header_size<U>();
+
+        char * raw_memory = rebind_allocator.allocate(header_size + count*sizeof(U));
+        if (raw_memory == nullptr) return nullptr;
+        U * object_memory = reinterpret_cast<U *>(raw_memory+header_size);
+        if (header_size) *reinterpret_cast<uintptr_type *>(raw_memory) = count;
+
+        detail::parallel_for_pages(object_memory, count, executor, 4096, 1u << 20,
+                                   [&](U *first, uintptr_type chunk_count) {
+                                       detail::construct_range(first, chunk_count, args...);
+                                   });
+        return object_memory;
+    }
+
+    /**
+     * Destruct in parallel and Deallocate an array, that was created using new_array or parallel_new_array
+     *
+     * @tparam U array item type
+     * @tparam allocator_type allocator type
+     * @tparam Executor executor type, see thread_executor
+     * @param pointer pointer to array
+     * @param allocator allocator, that was used to allocate memory for this array
+     * @param executor executor of the destruction tasks
+     */
+    template<class U, class allocator_type, class Executor>
+    void parallel_delete_array(U * pointer,
+                               const allocator_type & allocator,
+                               Executor && executor) {
+        using rebind_allocator_t = typename allocator_type::template rebind<char>::other;
+        rebind_allocator_t rebind_allocator(allocator);
+        constexpr auto header_size = detail::array_header_size<U>();
+
+        char * raw_memory = reinterpret_cast<char *>(pointer)-header_size;
+        if (header_size) {
+            const auto count = *reinterpret_cast<uintptr_type *>(raw_memory);
+            detail::parallel_for_pages(pointer, count, executor, 4096, 1u << 20,
+                                       [](U *first, uintptr_type chunk_count) {
+                                           detail::destroy_range(first, chunk_count);
+                                       });
+        }
+        rebind_allocator.deallocate(raw_memory);
+    }
+}
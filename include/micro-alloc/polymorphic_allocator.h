@@ -27,6 +27,14 @@ namespace micro_alloc {
         using memory = memory_resource;
         using uintptr_type = memory::uintptr_type;
         using size_t = uintptr_type;
+        using size_type = size_t;
+        using difference_type = long;
+        // like std::pmr, the resource stays with the container. Containers of equal resources
+        // still move and swap by stealing pointers, after comparing the allocators.
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+        using is_always_equal = std::false_type;
         static const uintptr_type default_align = sizeof(uintptr_type);
 
     private:
@@ -51,6 +59,10 @@ namespace micro_alloc {
 
         T *allocate(size_t n) { return (T *) _mem->malloc(n * sizeof(T)); }
         void deallocate(T *p, size_t n = 0) { _mem->free(p); }
+        /**
+         * try to resize an allocation in place to {n} objects, see memory_resource::expand
+         */
+        bool expand(T *p, size_t n) { return _mem->expand(p, n * sizeof(T)); }
         void *allocate_bytes(size_t nbytes, size_t alignment = default_align) {
             return _mem->malloc(nbytes);
         }
@@ -86,9 +98,15 @@ namespace micro_alloc {
         };
     };
 
-    template<class T1, class T2, typename uintptr_type>
+    template<class T1, class T2>
     bool operator==(const polymorphic_allocator<T1> &lhs,
                     const polymorphic_allocator<T2> &rhs) noexcept {
         return *(lhs.resource()) == *(rhs.resource());
     }
+
+    template<class T1, class T2>
+    bool operator!=(const polymorphic_allocator<T1> &lhs,
+                    const polymorphic_allocator<T2> &rhs) noexcept {
+        return !(lhs == rhs);
+    }
 }
\ No newline at end of file
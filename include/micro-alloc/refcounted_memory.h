@@ -0,0 +1,179 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+#include "traits.h"
+// <atomic> and <new> are freestanding headers, they do not require the standard library
+#include <atomic>
+#include <new>
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Refcounted Memory Resource:
+     *
+     * Adapter, that prefixes every block of an upstream memory resource (pool memory, dynamic
+     * memory etc..) with an intrusive reference count, so a block can be shared among several
+     * owners without a separate control block allocation. A block starts with a count of one,
+     * retain() increments it, and release() (or free()) decrements it, the block returns to the
+     * upstream when the count hits zero.
+     *
+     * - Allocations and frees are the complexity of the upstream memory
+     * - retain() and release() are O(1)
+     *
+     * Notes:
+     * - The header is the size of the upstream alignment, so payloads keep the upstream alignment.
+     *   Configure pool memory blocks to be larger by header_size().
+     * - With {Atomic=true}, blocks may be retained and released concurrently from many threads,
+     *   the upstream memory must then be thread safe or guarded by the user.
+     *
+     * Block is:
+     *  [ count | ..aligned data.. ]
+     *
+     * @tparam Atomic use an atomic reference count
+     *
+     * @author Tomer Riko Shalev
+     */
+    template<bool Atomic=false>
+    class refcounted_memory : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::ptr_to_int;
+        using base::int_to_ptr;
+        using base::try_throw;
+        using base::max;
+        using uintptr_type = memory_resource::uintptr_type;
+        using count_t = typename traits::conditional<Atomic, std::atomic<uptr>, uptr>::type;
+
+        memory_resource *_upstream;
+
+        static void increment(uptr &count) { count += 1; }
+        static void increment(std::atomic<uptr> &count) { count.fetch_add(1, std::memory_order_relaxed); }
+        static bool decrement(uptr &count) { return (count -= 1) == 0; }
+        static bool decrement(std::atomic<uptr> &count) {
+            return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+        static uptr load(const uptr &count) { return count; }
+        static uptr load(const std::atomic<uptr> &count) { return count.load(std::memory_order_relaxed); }
+
+        count_t *count_of(const void *pointer) const {
+            return reinterpret_cast<count_t *>(ptr_to_int(pointer) - header_size());
+        }
+
+    public:
+        refcounted_memory() = delete;
+
+        /**
+         * ctor
+         *
+         * @param upstream memory resource of the blocks
+         */
+        explicit refcounted_memory(memory_resource *upstream) :
+                base{16, upstream ? max(upstream->alignment, sizeof(uintptr_type)) : sizeof(uintptr_type)},
+                _upstream(upstream) {
+            this->_is_valid = upstream && upstream->is_valid();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: refcounted memory resource, " << (Atomic ? "atomic" : "non atomic")
+                      << " counts\n";
+            std::cout << "* header size is " << header_size() << " bytes" << std::endl;
+            if (!this->_is_valid)
+                std::cout << "* error:: upstream memory is not valid !!!\n";
+#endif
+            if (!this->_is_valid) try_throw();
+        }
+
+        ~refcounted_memory() override {
+            _upstream = nullptr;
+        }
+
+        memory_resource *upstream() const { return _upstream; }
+
+        /**
+         * bytes, that every block takes from the upstream on top of the requested size
+         */
+        uptr header_size() const { return align_up(sizeof(count_t)); }
+
+        uptr available_size() const override { return _upstream->available_size(); }
+
+        /**
+         * allocate a block with a reference count of one
+         */
+        void *malloc(uptr size_bytes) override {
+            void *block = _upstream->malloc(size_bytes + header_size());
+            if (!block) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "\nMALLOC:: refcounted memory\n- error, upstream is out of memory\n";
+#endif
+                try_throw();
+                return nullptr;
+            }
+            new(block) count_t(1);
+            return int_to_ptr(ptr_to_int(block) + header_size());
+        }
+
+        /**
+         * add an owner to a block
+         */
+        void retain(void *pointer) { increment(*count_of(pointer)); }
+
+        /**
+         * drop an owner of a block, the block returns to the upstream with it's last owner
+         * @return {true} if the block was returned to the upstream
+         */
+        bool release(void *pointer) {
+            count_t *count = count_of(pointer);
+            if (!decrement(*count)) return false;
+            count->~count_t();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nRELEASE:: refcounted memory\n- last owner released block @" << ptr_to_int(pointer) << "\n";
+#endif
+            return _upstream->free(count);
+        }
+
+        /**
+         * number of owners of a block
+         */
+        uptr use_count(const void *pointer) const { return load(*count_of(pointer)); }
+
+        /**
+         * same as release(), so the resource fits code, that frees every allocation
+         * @return {true} always, unless the upstream failed to free the block
+         */
+        bool free(void *pointer) override {
+            count_t *count = count_of(pointer);
+            if (!decrement(*count)) return true;
+            count->~count_t();
+            return _upstream->free(count);
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nPRINT:: refcounted memory\n";
+#endif
+            _upstream->print(true);
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            bool equals = this->type_id() == other.type_id();
+            if (!equals) return false;
+            const auto *casted_other = static_cast<const refcounted_memory *>(&other);
+            equals = this->_upstream == casted_other->_upstream;
+            return equals;
+        }
+    };
+}
@@ -0,0 +1,308 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Region Memory Resource:
+     *
+     * Hierarchical linear arenas. A root region owns the memory, and cuts it into fixed size
+     * chunks. Every region (root or child) allocates linearly inside chunks, that it draws from
+     * the root. Child regions are created from a parent region, which makes a tree of lifetimes,
+     * for example request -> transaction -> statement.
+     *
+     * - Allocations are O(1)
+     * - Free does not do anything, use release() instead
+     * - release() is O(regions in subtree), the chunks of every region are handed back
+     *   to the root at once, and are reused by later regions.
+     * - Destroying a region releases it's whole subtree, children of a destroyed region
+     *   become invalid and can not allocate anymore.
+     *
+     * Notes:
+     * - Allocations larger than a chunk (minus a small chunk header) are not supported
+     * - Not thread safe, regions of the same tree should be used by a single thread
+     *
+     * Chunk is:
+     *  [ next chunk | ..aligned data.. ]
+     *
+     * @author Tomer Riko Shalev
+     */
+    class region_memory : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::align_down;
+        using base::ptr_to_int;
+        using base::int_to_ptr;
+        using base::int_to;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using base::max;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        struct chunk_t { chunk_t *next = nullptr; };
+
+        // root only, the memory and it's chunks
+        void *_ptr;
+        uptr _size;
+        uptr _chunk_size;
+        uptr _carve_head;
+        uptr _carve_end;
+        chunk_t *_free_chunks;
+        uptr _free_chunks_count;
+
+        // tree of regions
+        region_memory *_root;
+        region_memory *_parent;
+        region_memory *_first_child;
+        region_memory *_prev_sibling;
+        region_memory *_next_sibling;
+
+        // chunks of this region, the head chunk is the current one
+        chunk_t *_chunks;
+        chunk_t *_chunks_tail;
+        uptr _chunks_count;
+        uptr _current;
+        uptr _current_end;
+
+        uptr size_of_chunk_header() const { return align_up(sizeof(chunk_t)); }
+        uptr chunk_payload_size() const { return _chunk_size - size_of_chunk_header(); }
+
+        // root only
+        chunk_t *acquire_chunk() {
+            chunk_t *chunk = nullptr;
+            if (_free_chunks) {
+                chunk = _free_chunks;
+                _free_chunks = chunk->next;
+                _free_chunks_count -= 1;
+            } else if (_carve_head + _chunk_size <= _carve_end) {
+                chunk = int_to<chunk_t *>(_carve_head);
+                _carve_head += _chunk_size;
+            }
+            return chunk;
+        }
+
+        // root only
+        void take_back_chunks(chunk_t *first, chunk_t *last, uptr count) {
+            last->next = _free_chunks;
+            _free_chunks = first;
+            _free_chunks_count += count;
+        }
+
+        void release_own_chunks() {
+            if (_chunks && _root) _root->take_back_chunks(_chunks, _chunks_tail, _chunks_count);
+            _chunks = _chunks_tail = nullptr;
+            _chunks_count = 0;
+            _current = _current_end = 0;
+        }
+
+        void link_to_parent() {
+            _next_sibling = _parent->_first_child;
+            if (_next_sibling) _next_sibling->_prev_sibling = this;
+            _parent->_first_child = this;
+        }
+
+        void unlink_from_parent() {
+            if (!_parent) return;
+            if (_prev_sibling) _prev_sibling->_next_sibling = _next_sibling;
+            else _parent->_first_child = _next_sibling;
+            if (_next_sibling) _next_sibling->_prev_sibling = _prev_sibling;
+            _parent = _prev_sibling = _next_sibling = nullptr;
+        }
+
+        // a region, that lost it's tree, can not allocate anymore
+        void orphan() {
+            for (region_memory *child = _first_child; child; child = child->_next_sibling)
+                child->orphan();
+            _chunks = _chunks_tail = nullptr;
+            _chunks_count = 0;
+            _current = _current_end = 0;
+            _root = nullptr;
+            this->_is_valid = false;
+        }
+
+    public:
+        bool is_root() const { return _root == this; }
+        region_memory *parent() const { return _parent; }
+        uptr chunk_size() const { return _chunk_size; }
+        uptr chunks_count() const { return _chunks_count; }
+
+        /**
+         * bytes left in the current chunk plus the bytes of all of the chunks, that the root can hand
+         */
+        uptr available_size() const override {
+            if (!_root) return 0;
+            const uptr uncarved_chunks = (_root->_carve_end - _root->_carve_head) / _chunk_size;
+            return (_current_end - _current) +
+                   (_root->_free_chunks_count + uncarved_chunks) * chunk_payload_size();
+        }
+
+        region_memory() = delete;
+        region_memory(const region_memory &) = delete;
+        region_memory &operator=(const region_memory &) = delete;
+
+        /**
+         * ctor of a root region, that owns the memory
+         *
+         * @param ptr start of memory
+         * @param size_bytes the memory size in bytes
+         * @param chunk_size size of chunks, that regions draw from the root
+         * @param alignment power of 2 alignment, that is >= alignment of pointer
+         */
+        region_memory(void *ptr, uptr size_bytes, uptr chunk_size, uptr alignment = sizeof(uintptr_type)) :
+                base{11, max(alignment, sizeof(uintptr_type))}, _ptr(ptr), _size(size_bytes),
+                _chunk_size(0), _carve_head(0), _carve_end(0), _free_chunks(nullptr), _free_chunks_count(0),
+                _root(this), _parent(nullptr), _first_child(nullptr), _prev_sibling(nullptr),
+                _next_sibling(nullptr), _chunks(nullptr), _chunks_tail(nullptr), _chunks_count(0),
+                _current(0), _current_end(0) {
+            const bool is_memory_valid_1 = is_alignment_pow_2();
+            if (is_memory_valid_1) {
+                _chunk_size = align_up(chunk_size);
+                _carve_head = align_up(ptr_to_int(ptr));
+                _carve_end = align_down(ptr_to_int(ptr) + size_bytes);
+            }
+            const bool is_memory_valid_2 = _chunk_size > size_of_chunk_header() &&
+                    _carve_end >= _carve_head + _chunk_size;
+            const bool is_memory_valid = is_memory_valid_1 and is_memory_valid_2;
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: root region memory resource\n";
+            std::cout << "* final alignment is " << this->alignment << " bytes" << std::endl;
+            std::cout << "* chunk size is " << _chunk_size << " bytes" << std::endl;
+            if (!is_memory_valid_1)
+                std::cout << "* error:: final alignment should be a power of 2\n";
+            if (!is_memory_valid_2)
+                std::cout << "* error:: memory does not satisfy minimal size requirements !!!\n";
+#endif
+            if (!is_memory_valid) try_throw();
+        }
+
+        /**
+         * ctor of a child region, that draws chunks from the root of {parent}, and
+         * is released with it
+         *
+         * @param parent the parent region
+         */
+        explicit region_memory(region_memory &parent) :
+                base{11, parent.alignment}, _ptr(nullptr), _size(0), _chunk_size(parent._chunk_size),
+                _carve_head(0), _carve_end(0), _free_chunks(nullptr), _free_chunks_count(0),
+                _root(parent._root), _parent(&parent), _first_child(nullptr), _prev_sibling(nullptr),
+                _next_sibling(nullptr), _chunks(nullptr), _chunks_tail(nullptr), _chunks_count(0),
+                _current(0), _current_end(0) {
+            const bool is_memory_valid = parent.is_valid() && _root;
+            this->_is_valid = is_memory_valid;
+            if (is_memory_valid) link_to_parent();
+            else _parent = nullptr;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: child region memory resource\n";
+            if (!is_memory_valid)
+                std::cout << "* error:: parent region is not valid !!!\n";
+#endif
+            if (!is_memory_valid) try_throw();
+        }
+
+        ~region_memory() override {
+            release();
+            for (region_memory *child = _first_child; child;) {
+                region_memory *next = child->_next_sibling;
+                child->orphan();
+                child->_parent = child->_prev_sibling = child->_next_sibling = nullptr;
+                child = next;
+            }
+            _first_child = nullptr;
+            unlink_from_parent();
+            _ptr = nullptr;
+            _size = 0;
+            this->_is_valid = false;
+        }
+
+        /**
+         * release the chunks of this region and of all of it's descendants back to the root,
+         * the regions stay alive and can allocate again
+         */
+        void release() {
+            for (region_memory *child = _first_child; child; child = child->_next_sibling)
+                child->release();
+            release_own_chunks();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nRELEASE:: region memory\n- released chunks of subtree\n";
+#endif
+        }
+
+        void *malloc(uptr size_bytes) override {
+            size_bytes = align_up(size_bytes);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nMALLOC:: region memory\n- requested " << size_bytes << " bytes (aligned up)\n";
+#endif
+            const bool is_possible = _root && size_bytes && size_bytes <= chunk_payload_size();
+            if (!is_possible) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error, region is not valid or size is 0 or bigger than a chunk\n";
+#endif
+                try_throw();
+                return nullptr;
+            }
+            if (_current + size_bytes > _current_end) {
+                chunk_t *chunk = _root->acquire_chunk();
+                if (!chunk) {
+#ifdef MICRO_ALLOC_DEBUG
+                    std::cout << "- error, root region is out of chunks\n";
+#endif
+                    try_throw();
+                    return nullptr;
+                }
+                chunk->next = _chunks;
+                if (!_chunks) _chunks_tail = chunk;
+                _chunks = chunk;
+                _chunks_count += 1;
+                _current = ptr_to_int(chunk) + size_of_chunk_header();
+                _current_end = ptr_to_int(chunk) + _chunk_size;
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- drew a new chunk from root, region has " << _chunks_count << " chunks\n";
+#endif
+            }
+            const uptr address = _current;
+            _current += size_bytes;
+            return int_to_ptr(address);
+        }
+
+        bool free(void *pointer) override {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nFREE:: region memory \n"
+                      << "- region memory does not free space, use release() instead \n";
+#endif
+            return false;
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            if (!embed)
+                std::cout << std::endl << "PRINT:: region memory " << std::endl;
+            std::cout << "- " << (is_root() ? "root" : "child") << " region with " << _chunks_count
+                      << " chunks, available size is " << available_size() << "\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+}
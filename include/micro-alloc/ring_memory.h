@@ -0,0 +1,317 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+// <atomic> is a freestanding header, it does not require the standard library
+#include <atomic>
+
+#ifdef MICRO_ALLOC_DEBUG
+#include <iostream>
+#endif
+
+namespace micro_alloc {
+
+    /**
+     * Ring Memory Resource:
+     *
+     * FIFO allocator, contiguous variable size blocks are allocated at the head, and are
+     * released at the tail in allocation order.
+     *
+     * Allocations are O(1)
+     * Free is O(1) amortized
+     *
+     * Notes:
+     * - Each block has a small header, that holds the size of the block and status bits.
+     * - When a block does not fit at the end of the memory, a skip marker is written over the
+     *   remaining space and the block is allocated at the beginning of the memory.
+     * - Out of order frees are tolerated, the block is marked as free, and it's space is
+     *   reclaimed once all the blocks before it are freed.
+     * - Single Producer/Single Consumer mode (spsc==true in constructor), is lock-free:
+     *   - One thread allocates with malloc() or reserve()/publish()
+     *   - One thread frees with free() or consumes messages with front()/pop()
+     *   - Requires std::atomic<uintptr_type> to be lock-free, which is true for every
+     *     mainstream platform.
+     * - In non-spsc mode, the ring rewinds to the beginning of the memory whenever it becomes empty.
+     *
+     * Block is:
+     *  [ size|status | ..aligned data.. ]
+     *
+     * @author Tomer Riko Shalev
+     */
+    class ring_memory : public memory_resource {
+    private:
+        using base = memory_resource;
+        using typename base::uptr;
+        using base::align_up;
+        using base::align_down;
+        using base::is_aligned;
+        using base::ptr_to_int;
+        using base::int_to_ptr;
+        using base::int_to;
+        using base::is_alignment_pow_2;
+        using base::try_throw;
+        using base::max;
+        using uintptr_type = memory_resource::uintptr_type;
+
+        struct header_t {
+            uptr size_and_status = 0;
+            static constexpr uptr freed_bit = 1;
+            static constexpr uptr skip_bit = 2;
+
+            uptr size() const { return size_and_status & ~(freed_bit | skip_bit); }
+            bool is_freed() const { return size_and_status & freed_bit; }
+            bool is_skip() const { return size_and_status & skip_bit; }
+            bool is_reclaimable() const { return size_and_status & (freed_bit | skip_bit); }
+        };
+
+        void *_ptr;
+        uptr _size;
+        uptr _start;
+        uptr _capacity;
+        bool _spsc;
+        // positions are offsets from {_start}, empty when head == tail
+        std::atomic<uptr> _head;
+        std::atomic<uptr> _tail;
+        // producer private head of reserved, but not yet published blocks
+        uptr _reserve_head;
+
+        std::memory_order acquire_order() const {
+            return _spsc ? std::memory_order_acquire : std::memory_order_relaxed;
+        }
+        std::memory_order release_order() const {
+            return _spsc ? std::memory_order_release : std::memory_order_relaxed;
+        }
+        uptr size_of_header() const { return align_up(sizeof(header_t)); }
+        header_t *header_at(uptr position) const { return int_to<header_t *>(_start + position); }
+        uptr wrap(uptr position) const { return position == _capacity ? 0 : position; }
+
+        /**
+         * consumer side, skip all reclaimable blocks at the tail
+         */
+        uptr advance_tail(uptr tail, uptr head) {
+            while (tail != head) {
+                const header_t *header = header_at(tail);
+                if (!header->is_reclaimable()) break;
+                tail = wrap(tail + header->size());
+            }
+            return tail;
+        }
+
+    public:
+        uptr start_aligned_address() const { return align_up(ptr_to_int(_ptr)); }
+        uptr end_aligned_address() const { return align_down(ptr_to_int(_ptr) + _size); }
+        bool is_spsc() const { return _spsc; }
+
+        ring_memory() = delete;
+
+        /**
+         * ctor
+         *
+         * @param ptr start of memory
+         * @param size_bytes the memory size in bytes
+         * @param alignment power of 2 alignment, that is >= alignment of pointer
+         * @param spsc if {true}, malloc and free are lock-free, when invoked from a single producer
+         *             thread and a single consumer thread.
+         */
+        ring_memory(void *ptr, uptr size_bytes, uptr alignment = sizeof(uintptr_type), bool spsc = false) :
+                base{9, max(alignment, sizeof(uintptr_type))}, _ptr(ptr), _size(size_bytes),
+                _start(0), _capacity(0), _spsc(spsc), _head(0), _tail(0), _reserve_head(0) {
+            const bool is_memory_valid_1 = is_alignment_pow_2();
+            const bool is_memory_valid_2 = is_memory_valid_1 &&
+                    end_aligned_address() > start_aligned_address() + 2 * size_of_header();
+            const bool is_memory_valid = is_memory_valid_1 and is_memory_valid_2;
+            this->_is_valid = is_memory_valid;
+
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nHELLO:: ring memory resource\n";
+            std::cout << "* requested alignment is " << alignment << " bytes" << std::endl;
+            std::cout << "* final alignment is " << this->alignment << " bytes" << std::endl;
+            std::cout << "* mode is " << (spsc ? "lock-free single producer/single consumer\n" : "single thread\n");
+            if (!is_memory_valid_1)
+                std::cout << "* error:: final alignment should be a power of 2\n";
+            if (!is_memory_valid_2)
+                std::cout << "* error:: memory does not satisfy minimal size requirements !!!\n";
+#endif
+            if (is_memory_valid) reset();
+            else try_throw();
+        }
+
+        ~ring_memory() override {
+            _ptr = nullptr;
+            _size = _capacity = 0;
+        }
+
+        /**
+         * free all blocks at once, not thread safe
+         */
+        void reset() {
+            _start = start_aligned_address();
+            _capacity = end_aligned_address() - _start;
+            _reserve_head = 0;
+            _head.store(0, std::memory_order_relaxed);
+            _tail.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * bytes, that are not occupied by blocks, not all of them might be usable by a single
+         * block, because blocks are contiguous
+         */
+        uptr available_size() const override {
+            const uptr head = _reserve_head;
+            const uptr tail = _tail.load(acquire_order());
+            return head >= tail ? _capacity - (head - tail) : tail - head;
+        }
+
+        /**
+         * producer side, allocate a block without making it visible to front()
+         * @param size_bytes size of block
+         * @return a pointer on success or {nullptr}
+         */
+        void *reserve(uptr size_bytes) {
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nMALLOC:: ring memory\n- requested " << size_bytes << " bytes\n";
+#endif
+            const uptr block_size = size_of_header() + align_up(size_bytes);
+            const uptr head = _reserve_head;
+            const uptr tail = _tail.load(acquire_order());
+            uptr block_start = _capacity;
+            uptr skip_size = 0;
+            if (size_bytes == 0) {
+            } else if (head >= tail) {
+                // head must never reach tail, because that means an empty ring
+                const uptr block_end = head + block_size;
+                const bool fits_at_end = block_end < _capacity || (block_end == _capacity && tail != 0);
+                if (fits_at_end) block_start = head;
+                else if (block_size < tail) {
+                    block_start = 0;
+                    skip_size = _capacity - head;
+                }
+            } else if (head + block_size < tail) block_start = head;
+
+            if (block_start == _capacity) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error, could not fulfill " << block_size << " bytes block, "
+                          << "available size is " << available_size() << "\n";
+#endif
+                try_throw();
+                return nullptr;
+            }
+
+            if (skip_size) {
+                header_at(head)->size_and_status = skip_size | header_t::skip_bit;
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- wrapped around, skipped " << skip_size << " bytes at the end\n";
+#endif
+            }
+            header_at(block_start)->size_and_status = block_size;
+            _reserve_head = wrap(block_start + block_size);
+            const uptr address = _start + block_start + size_of_header();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "- handed a block of " << block_size << " bytes @" << address << "\n";
+#endif
+            return int_to_ptr(address);
+        }
+
+        /**
+         * producer side, make all reserved blocks visible to the consumer
+         */
+        void publish() {
+            _head.store(_reserve_head, release_order());
+        }
+
+        void *malloc(uptr size_bytes) override {
+            void *pointer = reserve(size_bytes);
+            if (pointer) publish();
+            return pointer;
+        }
+
+        bool free(void *pointer) override {
+            const uptr address = ptr_to_int(pointer);
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nFREE:: ring memory\n- free a block address @ " << address << "\n";
+#endif
+            const bool is_in_range = address >= _start + size_of_header() && address < _start + _capacity &&
+                                     is_aligned(address);
+            header_t *header = is_in_range ? int_to<header_t *>(address - size_of_header()) : nullptr;
+            const bool is_block = header && header->size() && !header->is_reclaimable();
+            if (!is_block) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- error: address is not of an allocated block\n";
+#endif
+                try_throw();
+                return false;
+            }
+            header->size_and_status |= header_t::freed_bit;
+
+            // the tail might sit on a skip marker in front of this block, so advance it whenever
+            // the header at the tail is reclaimable, and not only when this block is the oldest
+            const uptr tail = _tail.load(std::memory_order_relaxed);
+            const uptr head = _head.load(acquire_order());
+            const uptr new_tail = advance_tail(tail, head);
+            if (new_tail == tail) {
+#ifdef MICRO_ALLOC_DEBUG
+                std::cout << "- block is not the oldest, marked as free for later\n";
+#endif
+                return true;
+            }
+            // when empty, rewind to the beginning, to keep the widest contiguous space
+            if (!_spsc && new_tail == _reserve_head) reset();
+            else _tail.store(new_tail, release_order());
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "- tail advanced, available size is " << available_size() << "\n";
+#endif
+            return true;
+        }
+
+        /**
+         * consumer side, get the oldest published block, that was not freed
+         * @param size_bytes optional, receives the usable size of the block
+         * @return a pointer or {nullptr} if there is nothing to consume
+         */
+        void *front(uptr *size_bytes = nullptr) {
+            const uptr head = _head.load(acquire_order());
+            uptr tail = _tail.load(std::memory_order_relaxed);
+            const uptr new_tail = advance_tail(tail, head);
+            if (new_tail != tail) _tail.store(tail = new_tail, release_order());
+            if (tail == head) return nullptr;
+            const header_t *header = header_at(tail);
+            if (size_bytes) *size_bytes = header->size() - size_of_header();
+            return int_to_ptr(_start + tail + size_of_header());
+        }
+
+        /**
+         * consumer side, free the block, that is returned by front()
+         * @return {true/false} on success/failure
+         */
+        bool pop() {
+            void *pointer = front();
+            return pointer ? free(pointer) : false;
+        }
+
+        void print(bool embed) const override {
+#ifdef MICRO_ALLOC_DEBUG
+            if (!embed)
+                std::cout << std::endl << "PRINT:: ring allocator " << std::endl;
+            std::cout << "- tail @" << _tail.load() << ", head @" << _head.load()
+                      << ", available size [" << available_size() << "/" << _capacity << "]\n";
+#endif
+        }
+
+        bool is_equal(const memory_resource &other) const noexcept override {
+            bool equals = this->type_id() == other.type_id();
+            if (!equals) return false;
+            const auto *casted_other = static_cast<const ring_memory *>(&other);
+            equals = this->_ptr == casted_other->_ptr;
+            return equals;
+        }
+    };
+}
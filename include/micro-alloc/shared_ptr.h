@@ -0,0 +1,184 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+// <atomic> and <new> are freestanding headers, they do not require the standard library
+#include <atomic>
+#include <new>
+
+namespace micro_alloc {
+
+    namespace detail {
+
+        /**
+         * control block of a shared_ptr, the object follows it in the same allocation
+         */
+        template<bool Atomic>
+        struct shared_control {
+            using count_t = typename traits::conditional<Atomic, std::atomic<uintptr_type>, uintptr_type>::type;
+            using dispose_t = void (*)(shared_control *);
+
+            count_t count;
+            dispose_t dispose;
+
+            explicit shared_control(dispose_t dispose) : count(1), dispose(dispose) {}
+
+            static void increment(uintptr_type &c) { c += 1; }
+            static void increment(std::atomic<uintptr_type> &c) { c.fetch_add(1, std::memory_order_relaxed); }
+            static bool decrement(uintptr_type &c) { return (c -= 1) == 0; }
+            static bool decrement(std::atomic<uintptr_type> &c) {
+                return c.fetch_sub(1, std::memory_order_acq_rel) == 1;
+            }
+            static uintptr_type load(const uintptr_type &c) { return c; }
+            static uintptr_type load(const std::atomic<uintptr_type> &c) { return c.load(std::memory_order_relaxed); }
+
+            void retain() { increment(count); }
+            void release() { if (decrement(count)) dispose(this); }
+            uintptr_type use_count() const { return load(count); }
+        };
+
+        /**
+         * control block, allocator and object in one allocation. The allocator is a base class,
+         * so stateless allocators take no space (empty base optimization).
+         */
+        template<class T, class Alloc, bool Atomic>
+        struct shared_block : shared_control<Atomic>,
+                              Alloc::template rebind<shared_block<T, Alloc, Atomic>>::other {
+            using control = shared_control<Atomic>;
+            using allocator = typename Alloc::template rebind<shared_block>::other;
+
+            T value;
+
+            template<class... Args>
+            explicit shared_block(const Alloc &alloc, Args &&... args) :
+                    control(&shared_block::destroy), allocator(alloc),
+                    value(micro_alloc::traits::forward<Args>(args)...) {}
+
+            static void destroy(control *c) {
+                auto *block = static_cast<shared_block *>(c);
+                allocator alloc(static_cast<const allocator &>(*block));
+                block->~shared_block();
+                alloc.deallocate(block, 1);
+            }
+        };
+    }
+
+    /**
+     * Shared Pointer:
+     *
+     * Reference counted pointer to an object, that was created with allocate_shared() by any
+     * micro-alloc allocator. The control block, the allocator and the object share a single
+     * allocation, the allocator is stored as an empty base, so stateless and static allocators
+     * (std_rebind_allocator, static_linear_allocator) cost zero bytes, and a polymorphic_allocator
+     * costs only it's resource pointer.
+     *
+     * Notes:
+     * - Counting is not atomic by default, set {Atomic=true} to share objects across threads
+     * - There are no weak pointers, the allocation is returned with the last owner
+     *
+     * @tparam T object type
+     * @tparam Atomic use an atomic reference count
+     */
+    template<class T, bool Atomic=false>
+    class shared_ptr {
+    private:
+        template<class U, bool A> friend class shared_ptr;
+        template<class U, bool A, class Alloc, class... Args>
+        friend shared_ptr<U, A> allocate_shared(const Alloc &alloc, Args &&... args);
+
+        using control = detail::shared_control<Atomic>;
+
+        T *_object;
+        control *_control;
+
+        shared_ptr(T *object, control *c) noexcept : _object(object), _control(c) {}
+
+    public:
+        using element_type = T;
+
+        shared_ptr() noexcept : _object(nullptr), _control(nullptr) {}
+        shared_ptr(decltype(nullptr)) noexcept : shared_ptr() {}
+        shared_ptr(const shared_ptr &other) noexcept : _object(other._object), _control(other._control) {
+            if (_control) _control->retain();
+        }
+        shared_ptr(shared_ptr &&other) noexcept : _object(other._object), _control(other._control) {
+            other._object = nullptr;
+            other._control = nullptr;
+        }
+        template<class U>
+        shared_ptr(const shared_ptr<U, Atomic> &other) noexcept : _object(other._object), _control(other._control) {
+            if (_control) _control->retain();
+        }
+        template<class U>
+        shared_ptr(shared_ptr<U, Atomic> &&other) noexcept : _object(other._object), _control(other._control) {
+            other._object = nullptr;
+            other._control = nullptr;
+        }
+        ~shared_ptr() { reset(); }
+
+        shared_ptr &operator=(shared_ptr other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        /**
+         * drop ownership, the object is destroyed and deallocated with it's last owner
+         */
+        void reset() noexcept {
+            if (_control) _control->release();
+            _object = nullptr;
+            _control = nullptr;
+        }
+
+        void swap(shared_ptr &other) noexcept {
+            T *object = _object; _object = other._object; other._object = object;
+            control *c = _control; _control = other._control; other._control = c;
+        }
+
+        T *get() const noexcept { return _object; }
+        T &operator*() const noexcept { return *_object; }
+        T *operator->() const noexcept { return _object; }
+        explicit operator bool() const noexcept { return _object != nullptr; }
+        uintptr_type use_count() const noexcept { return _control ? _control->use_count() : 0; }
+    };
+
+    template<class T1, class T2, bool Atomic>
+    bool operator==(const shared_ptr<T1, Atomic> &lhs, const shared_ptr<T2, Atomic> &rhs) noexcept {
+        return lhs.get() == rhs.get();
+    }
+
+    template<class T1, class T2, bool Atomic>
+    bool operator!=(const shared_ptr<T1, Atomic> &lhs, const shared_ptr<T2, Atomic> &rhs) noexcept {
+        return lhs.get() != rhs.get();
+    }
+
+    /**
+     * Allocate and Construct a shared object with a single allocation
+     *
+     * @tparam T object type
+     * @tparam Atomic use an atomic reference count
+     * @tparam Alloc allocator type
+     * @tparam Args constructor arg types
+     * @param alloc allocator to use, it is copied into the allocation
+     * @param args constructor arguments
+     * @return a shared pointer, that is empty if the allocation failed
+     */
+    template<class T, bool Atomic=false, class Alloc, class... Args>
+    shared_ptr<T, Atomic> allocate_shared(const Alloc &alloc, Args &&... args) {
+        using block_t = detail::shared_block<T, Alloc, Atomic>;
+        typename block_t::allocator block_alloc(alloc);
+        block_t *block = block_alloc.allocate(1);
+        if (!block) return shared_ptr<T, Atomic>();
+        new(block) block_t(alloc, micro_alloc::traits::forward<Args>(args)...);
+        return shared_ptr<T, Atomic>(&block->value, block);
+    }
+}
@@ -184,6 +184,31 @@ namespace micro_alloc {
             return true;
         }
 
+        /**
+         * only the latest allocated block (top of the stack) can grow or shrink in place
+         */
+        bool expand(void *pointer, uptr size_bytes) override {
+            const bool is_empty = _current_block_end == start_aligned_address();
+            if (is_empty || size_bytes == 0) return false;
+
+            footer_t *footer = int_to<footer_t *>(_current_block_end - sizeof(footer_t));
+            const uptr prev_block_end = _current_block_end - footer->distance_to_prev_block_end;
+            const uptr block_start = align_up(prev_block_end);
+            const bool is_top = ptr_to_int(pointer) == block_start;
+            const uptr start_of_footer = block_start + align_up(align_up(size_bytes), alignment_of_footer());
+            const uptr new_block_end = start_of_footer + sizeof(footer_t);
+            const bool has_space = new_block_end <= end_aligned_address();
+#ifdef MICRO_ALLOC_DEBUG
+            std::cout << "\nEXPAND:: stack allocator\n- request to resize block @" << ptr_to_int(pointer)
+                      << " to " << size_bytes << " bytes, " << (is_top && has_space ? "success\n" : "failure\n");
+#endif
+            if (!is_top || !has_space) return false;
+
+            _current_block_end = new_block_end;
+            int_to<footer_t *>(start_of_footer)->distance_to_prev_block_end = new_block_end - prev_block_end;
+            return true;
+        }
+
         void print(bool embed) const override {
 #ifdef MICRO_ALLOC_DEBUG
             if (!embed)
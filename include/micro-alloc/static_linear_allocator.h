@@ -10,6 +10,8 @@
 ========================================================================================*/
 #pragma once
 
+#include "traits.h"
+
 #ifdef MICRO_ALLOC_DEBUG
 #include <iostream>
 #endif
@@ -130,6 +132,13 @@ namespace micro_alloc {
         using memory_info = typename storage_type::memory_info_t;
         using value_type = T;
         using size_t = unsigned long;
+        using size_type = size_t;
+        using difference_type = long;
+        // the storage is static, every instance of the same (SizeBytes, BANK) is the same allocator
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::true_type;
 
         template<class U> explicit static_linear_allocator(
                 const static_linear_allocator<U, SizeBytes, BANK> &o) noexcept : static_linear_allocator() {
@@ -240,11 +249,16 @@ namespace micro_alloc {
 
     };
 
-    template<class T1, class T2, class uintptr_type,
-            unsigned Alignment, unsigned SizeBytes, unsigned BANK>
+    template<class T1, class T2, unsigned SizeBytes, unsigned BANK>
     bool operator==(const static_linear_allocator<T1, SizeBytes, BANK> &lhs,
                     const static_linear_allocator<T2, SizeBytes, BANK> &rhs) noexcept {
         // true for the same (SizeBytes, BANK) sequence
         return true;
     }
+
+    template<class T1, class T2, unsigned SizeBytes, unsigned BANK>
+    bool operator!=(const static_linear_allocator<T1, SizeBytes, BANK> &lhs,
+                    const static_linear_allocator<T2, SizeBytes, BANK> &rhs) noexcept {
+        return false;
+    }
 }
\ No newline at end of file
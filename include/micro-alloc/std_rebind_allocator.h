@@ -26,6 +26,13 @@ namespace micro_alloc {
     public:
         using value_type = T;
         using size_t = unsigned long;
+        using size_type = size_t;
+        using difference_type = long;
+        // new and delete are global, so every instance frees what another one allocated
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::true_type;
 
         template<class U>
         explicit std_rebind_allocator(const std_rebind_allocator<U> &other) noexcept {};
@@ -48,4 +55,9 @@ namespace micro_alloc {
     bool operator==(const std_rebind_allocator<T1> &lhs, const std_rebind_allocator<T2> &rhs) noexcept {
         return true;
     }
+
+    template<class T1, class T2>
+    bool operator!=(const std_rebind_allocator<T1> &lhs, const std_rebind_allocator<T2> &rhs) noexcept {
+        return false;
+    }
 }
\ No newline at end of file
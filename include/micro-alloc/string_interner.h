@@ -0,0 +1,262 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "memory_resource.h"
+#include "linear_memory.h"
+#include "polymorphic_allocator.h"
+#include "flat_hash_map.h"
+#include "vector.h"
+
+namespace micro_alloc {
+
+    /**
+     * non owning view of a sequence of chars
+     */
+    class string_ref {
+    private:
+        const char *_data;
+        uintptr_type _size;
+
+    public:
+        string_ref() : _data(""), _size(0) {}
+        string_ref(const char *data, uintptr_type size) : _data(data), _size(size) {}
+        string_ref(const char *c_str) : _data(c_str), _size(0) { while (c_str[_size]) _size += 1; }
+
+        const char *data() const { return _data; }
+        uintptr_type size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        char operator[](uintptr_type index) const { return _data[index]; }
+
+        bool operator==(const string_ref &other) const {
+            if (_size != other._size) return false;
+            for (uintptr_type ix = 0; ix < _size; ++ix)
+                if (_data[ix] != other._data[ix]) return false;
+            return true;
+        }
+        bool operator!=(const string_ref &other) const { return !(*this == other); }
+    };
+
+    namespace detail {
+
+        /**
+         * interned string in the arena, the chars and a null terminator follow it
+         */
+        struct intern_entry {
+            uintptr_type hash;
+            unsigned int size;
+            unsigned int id;
+
+            const char *data() const { return reinterpret_cast<const char *>(this + 1); }
+        };
+
+        /**
+         * key of the index, keeps the hash, so probing and rehashing never hash the chars again
+         */
+        struct intern_key {
+            const char *data;
+            uintptr_type hash;
+            uintptr_type size;
+
+            bool operator==(const intern_key &other) const {
+                return hash == other.hash && string_ref(data, size) == string_ref(other.data, other.size);
+            }
+        };
+
+        struct intern_key_hash {
+            uintptr_type operator()(const intern_key &key) const { return key.hash; }
+        };
+
+        inline uintptr_type hash_bytes(const char *data, uintptr_type size) {
+            // FNV-1a, then mixed, so the top 7 bits of the control bytes are well spread
+            unsigned long long hash = 0xcbf29ce484222325ULL;
+            for (uintptr_type ix = 0; ix < size; ++ix) {
+                hash ^= (unsigned char)data[ix];
+                hash *= 0x100000001b3ULL;
+            }
+            return mix_hash(hash ^ size);
+        }
+    }
+
+    /**
+     * String Interner:
+     *
+     * Stores every unique string once, in a chain of linear memory chunks, that are drawn from an
+     * upstream memory resource. Every string gets a 32 bit id, and keeps it's precomputed hash and
+     * length next to it's chars. The index is a flat_hash_map (SIMD probed control bytes), and
+     * the id table is a vector, both allocate from the upstream as well.
+     *
+     * - intern() and find() hash the string once and are O(1) on average
+     * - str() is O(1)
+     * - reset() forgets all the strings at once, and keeps the first chunk
+     *
+     * Notes:
+     * - Views and ids are stable until reset() or destruction
+     * - Strings are null terminated, so data() of a view can be used as a C string
+     * - Strings larger than a chunk get a chunk of their own
+     * - The upstream must support free(), for example std_memory or dynamic_memory
+     * - Not thread safe
+     *
+     * Chunk is:
+     *  [ next chunk | linear memory | ..[hash | size | id | chars\0]..]
+     *
+     * @author Tomer Riko Shalev
+     */
+    class string_interner {
+    public:
+        using id_type = unsigned int;
+        static constexpr id_type invalid_id = ~id_type(0);
+
+    private:
+        using uptr = uintptr_type;
+        using entry_t = detail::intern_entry;
+        using key_t = detail::intern_key;
+        using allocator_t = polymorphic_allocator<>;
+        using index_t = flat_hash_map<key_t, id_type, allocator_t, detail::intern_key_hash>;
+        using ids_t = vector<const entry_t *, allocator_t>;
+
+        struct chunk_t {
+            chunk_t *next;
+            linear_memory memory;
+
+            chunk_t(chunk_t *next, uptr size_bytes) : next(next), memory(this + 1, size_bytes) {}
+        };
+
+        memory_resource *_upstream;
+        uptr _chunk_size;
+        chunk_t *_chunks;
+        index_t _index;
+        ids_t _ids;
+
+        static uptr entry_size(uptr size) { return sizeof(entry_t) + size + 1; }
+
+        /**
+         * allocate {size_bytes} from the current chunk, or from a new chunk
+         */
+        void *allocate(uptr size_bytes) {
+            if (_chunks && _chunks->memory.available_size() >= size_bytes + sizeof(uptr))
+                return _chunks->memory.malloc(size_bytes);
+            const uptr chunk_bytes = size_bytes + sizeof(uptr) > _chunk_size ? size_bytes + sizeof(uptr) : _chunk_size;
+            void *raw = _upstream->malloc(sizeof(chunk_t) + chunk_bytes);
+            if (!raw) return nullptr;
+            _chunks = new(raw) chunk_t(_chunks, chunk_bytes);
+            return _chunks->memory.malloc(size_bytes);
+        }
+
+        /**
+         * return the chunks from {chunk} up to {last} (excluded) to the upstream
+         */
+        void free_chunks(chunk_t *chunk, chunk_t *last = nullptr) {
+            while (chunk != last) {
+                chunk_t *next = chunk->next;
+                chunk->~chunk_t();
+                _upstream->free(chunk);
+                chunk = next;
+            }
+        }
+
+        key_t key_of(string_ref str) const {
+            return key_t{str.data(), detail::hash_bytes(str.data(), str.size()), str.size()};
+        }
+
+    public:
+        string_interner() = delete;
+        string_interner(const string_interner &) = delete;
+        string_interner &operator=(const string_interner &) = delete;
+
+        /**
+         * ctor
+         *
+         * @param upstream memory resource of the chunks, the index and the id table
+         * @param chunk_size size of a chunk in bytes
+         */
+        explicit string_interner(memory_resource *upstream, uptr chunk_size = 1u << 16) :
+                _upstream(upstream), _chunk_size(chunk_size), _chunks(nullptr),
+                _index(allocator_t(upstream)), _ids(allocator_t(upstream)) {}
+
+        ~string_interner() {
+            free_chunks(_chunks);
+            _chunks = nullptr;
+        }
+
+        /**
+         * @return the id of {str}, the string is copied into the arena if it is new,
+         *         or {invalid_id} if the upstream is out of memory
+         */
+        id_type intern(string_ref str) {
+            const key_t key = key_of(str);
+            const id_type *found = _index.find(key);
+            if (found) return *found;
+            if (_ids.size() == invalid_id || str.size() > invalid_id) return invalid_id;
+            const id_type id = id_type(_ids.size());
+            if (!_ids.push_back(nullptr)) return invalid_id;
+
+            auto *entry = static_cast<entry_t *>(allocate(entry_size(str.size())));
+            if (!entry) {
+                _ids.pop_back();
+                return invalid_id;
+            }
+            entry->hash = key.hash;
+            entry->size = (unsigned int)str.size();
+            entry->id = id;
+            char *chars = const_cast<char *>(entry->data());
+            for (uptr ix = 0; ix < str.size(); ++ix) chars[ix] = str[ix];
+            chars[str.size()] = '\0';
+
+            // the key points at the stable copy in the arena
+            if (!_index.insert(key_t{chars, key.hash, key.size}, id)) {
+                _ids.pop_back();
+                return invalid_id;
+            }
+            _ids[id] = entry;
+            return id;
+        }
+
+        /**
+         * @return the id of {str}, or {invalid_id} if it was not interned
+         */
+        id_type find(string_ref str) const {
+            const id_type *found = _index.find(key_of(str));
+            return found ? *found : invalid_id;
+        }
+
+        /**
+         * @return the interned string of {id}, it is valid until reset()
+         */
+        string_ref str(id_type id) const { return string_ref(_ids[id]->data(), _ids[id]->size); }
+
+        /**
+         * @return the precomputed hash of the string of {id}
+         */
+        uptr hash_of(id_type id) const { return _ids[id]->hash; }
+
+        /**
+         * number of unique strings
+         */
+        uptr size() const { return _ids.size(); }
+
+        /**
+         * forget all the strings, every view and id becomes invalid. The first chunk, the index and
+         * the id table keep their memory for the next strings.
+         */
+        void reset() {
+            if (_chunks) {
+                chunk_t *first = _chunks;
+                while (first->next) first = first->next;
+                free_chunks(_chunks, first);
+                _chunks = first;
+                _chunks->memory.reset();
+            }
+            _index.clear();
+            _ids.clear();
+        }
+    };
+}
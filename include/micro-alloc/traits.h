@@ -10,6 +10,10 @@
 ========================================================================================*/
 #pragma once
 
+// <type_traits> is a freestanding header, it does not require the standard library. It is used
+// only for the std::true_type/std::false_type allocator traits, that standard containers dispatch on.
+#include <type_traits>
+
 namespace micro_alloc {
 
     namespace traits {
@@ -48,6 +52,54 @@ namespace micro_alloc {
         typedef integral_constant<bool, true> true_type;
         typedef integral_constant<bool, false> false_type;
 
+        /**
+         * is T a class without non-static data members, uses the compiler builtin
+         */
+        template<class T> struct is_empty : integral_constant<bool, __is_empty(T)> {};
+
+        template<bool B, class T = void> struct enable_if {};
+        template<class T> struct enable_if<true, T> { typedef T type; };
+
+        template<class T, class U> struct is_same : false_type {};
+        template<class T> struct is_same<T, T> : true_type {};
+
+        template<class T> struct remove_cv { typedef T type; };
+        template<class T> struct remove_cv<const T> { typedef T type; };
+        template<class T> struct remove_cv<volatile T> { typedef T type; };
+        template<class T> struct remove_cv<const volatile T> { typedef T type; };
+
+        /**
+         * the type at index I of a pack
+         */
+        template<unsigned I, class T, class... Ts> struct type_at { typedef typename type_at<I - 1, Ts...>::type type; };
+        template<class T, class... Ts> struct type_at<0, T, Ts...> { typedef T type; };
+
+        template<class T> struct remove_cvref {
+            typedef typename remove_cv<typename remove_reference<T>::type>::type type;
+        };
+
+        /**
+         * type properties, that use the compiler builtins, so no standard library is required
+         */
+#if defined(__GNUC__) && !defined(__clang__)
+        template<class T> struct is_trivially_destructible : integral_constant<bool, __has_trivial_destructor(T)> {};
+#else
+        template<class T> struct is_trivially_destructible : integral_constant<bool, __is_trivially_destructible(T)> {};
+#endif
+        template<class T> struct is_trivially_default_constructible :
+                integral_constant<bool, __is_trivially_constructible(T)> {};
+        template<class T> struct is_trivially_copyable : integral_constant<bool, __is_trivially_copyable(T)> {};
+
+        /**
+         * can objects of T be moved to another address with a memcpy, and without destructing the
+         * source. It holds for trivially copyable types, other types opt-in by specializing it, for
+         * example, types, that hold a pointer to heap memory, but never a pointer into themselves:
+         *
+         *   template<> struct micro_alloc::traits::is_trivially_relocatable<my_string> : true_type {};
+         */
+        template<class T> struct is_trivially_relocatable :
+                integral_constant<bool, __is_trivially_copyable(T)> {};
+
     }
 
     template<bool B, class T, class F>
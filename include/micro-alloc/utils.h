@@ -11,16 +11,174 @@
 #pragma once
 
 #include "traits.h"
+// <new> is a freestanding header, it is used for placement new
+#include <new>
 
 namespace micro_alloc {
 
+    namespace detail {
+
+        /**
+         * size of the count header in front of an array, trivially destructible types
+         * have none, otherwise it is a multiple of alignof(U), so the array stays aligned
+         */
+        template<class U>
+        constexpr uintptr_type array_header_size() {
+            return micro_alloc::traits::is_trivially_destructible<U>::value ? 0 :
+                   (alignof(U) > sizeof(uintptr_type) ? alignof(U) : sizeof(uintptr_type));
+        }
+
+        inline void zero_bytes(void *pointer, uintptr_type size_bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_memset(pointer, 0, size_bytes);
+#else
+            auto * bytes = static_cast<unsigned char *>(pointer);
+            for (uintptr_type ix = 0; ix < size_bytes; ++ix) bytes[ix] = 0;
+#endif
+        }
+
+        inline void copy_bytes(void *destination, const void *source, uintptr_type size_bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_memcpy(destination, source, size_bytes);
+#else
+            auto * to = static_cast<unsigned char *>(destination);
+            const auto * from = static_cast<const unsigned char *>(source);
+            for (uintptr_type ix = 0; ix < size_bytes; ++ix) to[ix] = from[ix];
+#endif
+        }
+
+        /**
+         * relocation of trivially relocatable types is a single memcpy, otherwise every
+         * object is move constructed at the destination, and destructed at the source
+         */
+        template<class U>
+        void relocate_range(U * from, uintptr_type count, U * to, micro_alloc::traits::true_type) {
+            copy_bytes(to, from, count * sizeof(U));
+        }
+        template<class U>
+        void relocate_range(U * from, uintptr_type count, U * to, micro_alloc::traits::false_type) {
+            for (uintptr_type ix = 0; ix < count; ++ix) {
+                new(to + ix) U(micro_alloc::traits::move(from[ix]));
+                (from + ix)->~U();
+            }
+        }
+
+        /**
+         * value-init of trivial types is zero-init, which is a single memset
+         */
+        template<class U>
+        void value_init_range(U * first, uintptr_type count, micro_alloc::traits::true_type) {
+            zero_bytes(first, count * sizeof(U));
+        }
+        template<class U>
+        void value_init_range(U * first, uintptr_type count, micro_alloc::traits::false_type) {
+            for (uintptr_type ix = 0; ix < count; ++ix) new(first + ix) U();
+        }
+
+        /**
+         * copy-init of trivially copyable types from a local copy, a loop, that compilers vectorize
+         */
+        template<class U, class V>
+        void copy_init_range(U * first, uintptr_type count, V && value, micro_alloc::traits::true_type) {
+            const U copy(value);
+            for (uintptr_type ix = 0; ix < count; ++ix) new(first + ix) U(copy);
+        }
+        template<class U, class V>
+        void copy_init_range(U * first, uintptr_type count, V && value, micro_alloc::traits::false_type) {
+            for (uintptr_type ix = 0; ix < count; ++ix) new(first + ix) U(value);
+        }
+
+        /**
+         * construct {count} objects at {first}, dispatches at compile time to a memset for
+         * value-init of trivial types, and to a fill for copy-init of trivially copyable types
+         */
+        template<class U>
+        void construct_range(U * first, uintptr_type count) {
+            using is_trivial = micro_alloc::traits::integral_constant<bool,
+                    micro_alloc::traits::is_trivially_default_constructible<U>::value &&
+                    micro_alloc::traits::is_trivially_copyable<U>::value>;
+            value_init_range(first, count, is_trivial());
+        }
+        template<class U, class V>
+        void construct_range(U * first, uintptr_type count, V && value) {
+            using is_fill = micro_alloc::traits::integral_constant<bool,
+                    micro_alloc::traits::is_same<typename micro_alloc::traits::remove_cvref<V>::type, U>::value &&
+                    micro_alloc::traits::is_trivially_copyable<U>::value>;
+            copy_init_range(first, count, micro_alloc::traits::forward<V>(value), is_fill());
+        }
+        template<class U, class... Args>
+        void construct_range(U * first, uintptr_type count, Args &&... args) {
+            for (uintptr_type ix = 0; ix < count; ++ix)
+                new(first + ix) U(args...);
+        }
+
+        /**
+         * destruct {count} objects at {first}, does nothing for trivially destructible types
+         */
+        template<class U>
+        void destroy_range(U * /*first*/, uintptr_type /*count*/, micro_alloc::traits::true_type) {}
+        template<class U>
+        void destroy_range(U * first, uintptr_type count, micro_alloc::traits::false_type) {
+            for (uintptr_type ix = 0; ix < count; ++ix) (first + ix)->~U();
+        }
+        template<class U>
+        void destroy_range(U * first, uintptr_type count) {
+            destroy_range(first, count, micro_alloc::traits::is_trivially_destructible<U>());
+        }
+
+        /**
+         * holds an allocator, stateless allocators are an empty base, so they take no space
+         */
+        template<class Alloc, bool Empty = traits::is_empty<Alloc>::value>
+        class allocator_holder : private Alloc {
+        public:
+            allocator_holder() : Alloc() {}
+            explicit allocator_holder(const Alloc &alloc) : Alloc(alloc) {}
+            Alloc &allocator() { return *this; }
+            const Alloc &allocator() const { return *this; }
+            void assign(const Alloc &) {}
+        };
+
+        /**
+         * holds a stateful allocator, like polymorphic_allocator, which is just a resource pointer.
+         * Allocators might not be assignable, so assignment re-constructs it in place.
+         */
+        template<class Alloc>
+        class allocator_holder<Alloc, false> {
+        private:
+            Alloc _alloc;
+
+        public:
+            allocator_holder() : _alloc() {}
+            explicit allocator_holder(const Alloc &alloc) : _alloc(alloc) {}
+            Alloc &allocator() { return _alloc; }
+            const Alloc &allocator() const { return _alloc; }
+            void assign(const Alloc &alloc) {
+                _alloc.~Alloc();
+                new(&_alloc) Alloc(alloc);
+            }
+        };
+
+        /**
+         * call {allocator.expand(pointer, count)} if the allocator has it, otherwise it is {false}
+         */
+        template<class A, class P>
+        auto try_expand(A & allocator, P * pointer, uintptr_type count, int) -> decltype(allocator.expand(pointer, count)) {
+            return allocator.expand(pointer, count);
+        }
+        template<class A, class P>
+        bool try_expand(A &, P *, uintptr_type, long) { return false; }
+    }
+
     /**
      * Allocate and Construct new array with allocator.
      * NOTE:
-     * - Header info with size of array is extra allocated and written
+     * - Header info with size of array is extra allocated and written, only for types, that
+     *   are not trivially destructible. The header size is a multiple of alignof(U).
      * - You can only release this array with delete_array function
-     * - ASSUMES the alignment of the allocator is >= alignment requirement of micro_alloc::uintptr_type,
+     * - ASSUMES the alignment of the allocator is >= max(alignof(U), alignment of micro_alloc::uintptr_type),
      *   otherwise, this will fail on computers that do not allow un-aligned access.
+     * - Value-init of trivial types is a memset, and copy-init of trivially copyable types is a fill
      *
      * @tparam U value type
      * @tparam allocator_type allocator type
@@ -38,25 +196,20 @@ namespace micro_alloc {
         using rebind_allocator_t = typename allocator_type::template rebind<char>::other;
         rebind_allocator_t rebind_allocator(allocator);
 
-        // calculate info header size, note:
-        // offset has to be a number that is divisible by the allocation
-        // alignment (most allocators can only handle static/one alignment value).
-        // 32 is an absolute max that is divisible by all alignments. (we can settle for 8 even).
-        const auto header_size = 16;
+        // info header size, zero for trivially destructible types, which do not need the count
+        constexpr auto header_size = detail::array_header_size<U>();
 
         // allocate memory + info header
         char * raw_memory = rebind_allocator.allocate(header_size + count*sizeof(U));
+        if (raw_memory == nullptr) return nullptr;
         U * object_memory = reinterpret_cast<U *>(raw_memory+header_size);
 
         // write info header, uintptr_type is big enough to store any pointer,
         // therefore it is a legit holder for count limits
-        using uintptr_type = micro_alloc::uintptr_type;
-        auto * header = reinterpret_cast<uintptr_type *>(raw_memory);
-        *header = count;
+        if (header_size) *reinterpret_cast<uintptr_type *>(raw_memory) = count;
 
         // construct the array objects
-        for (int ix = 0; ix < count; ++ix)
-            new(object_memory+ix) U(micro_alloc::traits::forward<Args>(args)...);
+        detail::construct_range(object_memory, count, micro_alloc::traits::forward<Args>(args)...);
 
         return object_memory;
     }
@@ -76,22 +229,269 @@ namespace micro_alloc {
         rebind_allocator_t rebind_allocator(allocator);
 
         // calculate info header size
-        using uintptr_type = micro_alloc::uintptr_type;
-        const auto header_size = 16;
+        constexpr auto header_size = detail::array_header_size<U>();
 
         // get original raw memory with header
         char * raw_memory = reinterpret_cast<char *>(pointer)-header_size;
 
-        // read count
-        const auto count = *reinterpret_cast<uintptr_type *>(raw_memory);
-
-        // destruct objects in array
-        for (int ix = 0; ix < count; ++ix) (pointer+ix)->~U();
+        // destruct objects in array, trivially destructible types have no count and no destructors
+        if (header_size) {
+            const auto count = *reinterpret_cast<uintptr_type *>(raw_memory);
+            detail::destroy_range(pointer, count);
+        }
 
         // de-allocate memory
         rebind_allocator.deallocate(raw_memory);
     }
 
+    /**
+     * Relocate objects to an uninitialized destination. Afterwards the source holds no objects.
+     * NOTE:
+     * - Trivially relocatable types (see traits::is_trivially_relocatable) are moved with a memcpy
+     * - The ranges must not overlap
+     *
+     * @tparam U object type
+     * @param from first object to relocate
+     * @param count number of objects
+     * @param to uninitialized destination
+     * @return end of the destination range
+     */
+    template<class U>
+    U * relocate(U * from, uintptr_type count, U * to) {
+        detail::relocate_range(from, count, to, micro_alloc::traits::is_trivially_relocatable<U>());
+        return to + count;
+    }
+
+    /**
+     * Resize an array, that was created using new_array function. The block is resized in place
+     * if the allocator has an expand method, that succeeds, otherwise a new block is allocated,
+     * and existing objects are relocated into it. Surplus objects are destructed, and new objects
+     * are constructed with {args}.
+     * NOTE:
+     * - Trivially relocatable types are moved with a single memcpy
+     * - Upon failure {nullptr} is returned, and the original array is left untouched
+     * - {nullptr} array is the same as new_array
+     *
+     * @tparam U value type
+     * @tparam allocator_type allocator type
+     * @tparam Args args for constructor
+     * @param pointer pointer to array, or {nullptr}
+     * @param old_count current number of objects in array
+     * @param new_count requested number of objects in array
+     * @param allocator allocator, that was used to allocate memory for this array
+     * @param args variadic args for constructor of new objects
+     * @return a pointer to the resized array
+     */
+    template<class U, class allocator_type, class... Args>
+    U * realloc_array(U * pointer,
+                      const uintptr_type old_count,
+                      const uintptr_type new_count,
+                      const allocator_type & allocator,
+                      Args &&... args) {
+        if (pointer == nullptr)
+            return new_array<U>(new_count, allocator, micro_alloc::traits::forward<Args>(args)...);
+
+        // rebind the allocator to byte allocator
+        using rebind_allocator_t = typename allocator_type::template rebind<char>::other;
+        rebind_allocator_t rebind_allocator(allocator);
+        constexpr auto header_size = detail::array_header_size<U>();
+        char * old_raw_memory = reinterpret_cast<char *>(pointer)-header_size;
+
+        // resize in place if the allocator supports it
+        if (detail::try_expand(rebind_allocator, old_raw_memory, header_size + new_count*sizeof(U), 0)) {
+            if (old_count > new_count) detail::destroy_range(pointer + new_count, old_count - new_count);
+            if (new_count > old_count)
+                detail::construct_range(pointer + old_count, new_count - old_count,
+                                        micro_alloc::traits::forward<Args>(args)...);
+            if (header_size) *reinterpret_cast<uintptr_type *>(old_raw_memory) = new_count;
+            return pointer;
+        }
+
+        // allocate the new block
+        char * raw_memory = rebind_allocator.allocate(header_size + new_count*sizeof(U));
+        if (raw_memory == nullptr) return nullptr;
+        U * object_memory = reinterpret_cast<U *>(raw_memory+header_size);
+        if (header_size) *reinterpret_cast<uintptr_type *>(raw_memory) = new_count;
+
+        // relocate the kept objects, destruct the surplus and construct the new ones
+        const uintptr_type kept = old_count < new_count ? old_count : new_count;
+        relocate(pointer, kept, object_memory);
+        if (old_count > kept) detail::destroy_range(pointer + kept, old_count - kept);
+        if (new_count > kept)
+            detail::construct_range(object_memory + kept, new_count - kept,
+                                    micro_alloc::traits::forward<Args>(args)...);
+
+        rebind_allocator.deallocate(old_raw_memory);
+        return object_memory;
+    }
+
+    /**
+     * A typed view over a contiguous array, that is not owned
+     */
+    template<class T>
+    class aligned_span {
+    private:
+        T * _data;
+        uintptr_type _size;
+
+    public:
+        aligned_span(T * data, uintptr_type size) : _data(data), _size(size) {}
+
+        T * data() const { return _data; }
+        uintptr_type size() const { return _size; }
+        T & operator[](uintptr_type index) const { return _data[index]; }
+        T * begin() const { return _data; }
+        T * end() const { return _data + _size; }
+    };
+
+    namespace detail {
+
+        constexpr uintptr_type align_up(uintptr_type value, uintptr_type alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        /**
+         * layout of the columns of a struct of arrays, one column per type
+         */
+        template<class... Ts> struct soa_layout {
+            static constexpr uintptr_type max_alignment() { return 1; }
+            static uintptr_type place(void ** /*columns*/, uintptr_type offset, uintptr_type /*base*/,
+                                      uintptr_type /*count*/, uintptr_type /*alignment*/) { return offset; }
+            static void construct(void ** /*columns*/, uintptr_type /*count*/) {}
+            static void destroy(void ** /*columns*/, uintptr_type /*count*/) {}
+        };
+
+        template<class T, class... Ts> struct soa_layout<T, Ts...> {
+            // the largest alignment of the column types
+            static constexpr uintptr_type max_alignment() {
+                return alignof(T) > soa_layout<Ts...>::max_alignment() ? alignof(T) : soa_layout<Ts...>::max_alignment();
+            }
+            static uintptr_type place(void ** columns, uintptr_type offset, uintptr_type base,
+                                      uintptr_type count, uintptr_type alignment) {
+                offset = align_up(offset, alignment > alignof(T) ? alignment : alignof(T));
+                if (base) columns[0] = reinterpret_cast<void *>(base + offset);
+                return soa_layout<Ts...>::place(columns + 1, offset + count * sizeof(T), base, count, alignment);
+            }
+            static void construct(void ** columns, uintptr_type count) {
+                construct_range(static_cast<T *>(columns[0]), count);
+                soa_layout<Ts...>::construct(columns + 1, count);
+            }
+            static void destroy(void ** columns, uintptr_type count) {
+                destroy_range(static_cast<T *>(columns[0]), count);
+                soa_layout<Ts...>::destroy(columns + 1, count);
+            }
+        };
+    }
+
+    namespace detail { struct soa_access; }
+
+    /**
+     * A struct of arrays, that was created using new_soa function. It is a view,
+     * release it with delete_soa function.
+     *
+     * @tparam Ts the types of the columns
+     */
+    template<class... Ts>
+    class soa_view {
+        static_assert(sizeof...(Ts) > 0, "a struct of arrays needs at least one column");
+
+    private:
+        friend struct detail::soa_access;
+
+        void * _columns[sizeof...(Ts)];
+        uintptr_type _count;
+        void * _raw;
+
+    public:
+        soa_view() : _columns(), _count(0), _raw(nullptr) {}
+
+        /**
+         * the column of the I-th type
+         */
+        template<unsigned I>
+        aligned_span<typename micro_alloc::traits::type_at<I, Ts...>::type> get() const {
+            using column_t = typename micro_alloc::traits::type_at<I, Ts...>::type;
+            return aligned_span<column_t>(static_cast<column_t *>(_columns[I]), _count);
+        }
+
+        /**
+         * number of elements in every column
+         */
+        uintptr_type size() const { return _count; }
+        explicit operator bool() const { return _raw != nullptr; }
+    };
+
+    namespace detail {
+        struct soa_access {
+            template<class... Ts> static void ** columns(soa_view<Ts...> & view) { return view._columns; }
+            template<class... Ts> static uintptr_type & count(soa_view<Ts...> & view) { return view._count; }
+            template<class... Ts> static void *& raw(soa_view<Ts...> & view) { return view._raw; }
+        };
+    }
+
+    /**
+     * Allocate and value Construct a struct of arrays with a single allocation.
+     * NOTE:
+     * - Every column is aligned to {alignment} (cache line by default, or a SIMD width),
+     *   or to the alignment of it's type if it is larger
+     * - The allocation is padded, so the alignment holds with any allocator alignment
+     * - Columns of trivial types are zeroed with a memset
+     * - You can only release this struct of arrays with delete_soa function
+     *
+     * @tparam Ts the types of the columns
+     * @tparam allocator_type allocator type
+     * @param count how many elements in every column
+     * @param allocator allocator instance
+     * @param alignment power of 2 alignment of the columns
+     * @return a view of the columns, that evaluates to false upon failure
+     */
+    template<class... Ts, class allocator_type>
+    soa_view<Ts...> new_soa(const uintptr_type count,
+                            const allocator_type & allocator,
+                            const uintptr_type alignment = 64) {
+        // rebind the allocator to byte allocator
+        using rebind_allocator_t = typename allocator_type::template rebind<char>::other;
+        rebind_allocator_t rebind_allocator(allocator);
+        using layout = detail::soa_layout<Ts...>;
+
+        soa_view<Ts...> view;
+        // column offsets are aligned relative to the base, so the base is aligned to the
+        // largest of the requested alignment and the alignments of the column types
+        const uintptr_type base_alignment = alignment > layout::max_alignment() ? alignment : layout::max_alignment();
+        // size of all the aligned columns, and padding to align the first one
+        const uintptr_type size = layout::place(nullptr, 0, 0, count, alignment);
+        char * raw_memory = rebind_allocator.allocate(size + base_alignment - 1);
+        if (raw_memory == nullptr) return view;
+
+        // place and construct the columns
+        const uintptr_type base = detail::align_up(reinterpret_cast<uintptr_type>(raw_memory), base_alignment);
+        layout::place(detail::soa_access::columns(view), 0, base, count, alignment);
+        layout::construct(detail::soa_access::columns(view), count);
+        detail::soa_access::count(view) = count;
+        detail::soa_access::raw(view) = raw_memory;
+        return view;
+    }
+
+    /**
+     * Destruct and Deallocate a struct of arrays, that was created using new_soa function
+     * @tparam allocator_type allocator type
+     * @tparam Ts the types of the columns
+     * @param view the struct of arrays, it is empty afterwards
+     * @param allocator allocator, that was used to allocate memory for this struct of arrays
+     */
+    template<class allocator_type, class... Ts>
+    void delete_soa(soa_view<Ts...> & view,
+                    const allocator_type & allocator) {
+        if (!view) return;
+        // rebind the allocator to byte allocator
+        using rebind_allocator_t = typename allocator_type::template rebind<char>::other;
+        rebind_allocator_t rebind_allocator(allocator);
+
+        detail::soa_layout<Ts...>::destroy(detail::soa_access::columns(view), view.size());
+        rebind_allocator.deallocate(static_cast<char *>(detail::soa_access::raw(view)));
+        view = soa_view<Ts...>();
+    }
+
     /**
      * Allocate and Construct a single object
      * @tparam U object type
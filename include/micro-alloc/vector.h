@@ -0,0 +1,223 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+#include "utils.h"
+
+namespace micro_alloc {
+
+    /**
+     * Vector:
+     *
+     * Dynamic array, that is aware of micro-alloc memory resources. When it runs out of
+     * capacity, it first tries to grow the buffer in place with the expand method of the
+     * allocator (polymorphic_allocator forwards it to memory_resource::expand), which succeeds
+     * for the top block of a stack or linear memory, or a block with a free right neighbour
+     * in a dynamic memory. Otherwise, it allocates a new buffer and relocates the elements,
+     * with a single memcpy for trivially relocatable types.
+     *
+     * Notes:
+     * - Capacity doubles on growth, in place growth first tries the doubled capacity, and then
+     *   the exact required size
+     * - Stateless allocators take no space
+     * - Allocation failure leaves the vector untouched, and push/emplace return {false}
+     *
+     * @tparam T value type
+     * @tparam Alloc allocator type, it is rebound to T
+     */
+    template<class T, class Alloc>
+    class vector : private detail::allocator_holder<typename Alloc::template rebind<T>::other> {
+    public:
+        using value_type = T;
+        using size_type = uintptr_type;
+        using allocator_type = typename Alloc::template rebind<T>::other;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+    private:
+        using holder = detail::allocator_holder<allocator_type>;
+
+        T *_data;
+        size_type _size;
+        size_type _capacity;
+
+        /**
+         * make room for at least {capacity} elements, in place or in a new buffer, the elements
+         * are not moved yet, so arguments, that point into the old buffer, are still valid
+         * @return the buffer, that is {_data} if it grew in place, or {nullptr} if the allocation failed
+         */
+        T *grow_buffer(size_type capacity, size_type &target) {
+            target = _capacity * 2 > capacity ? _capacity * 2 : capacity;
+            if (target < 4) target = 4;
+            allocator_type &alloc = holder::allocator();
+            if (_data) {
+                if (detail::try_expand(alloc, _data, target, 0)) return _data;
+                if (target != capacity && detail::try_expand(alloc, _data, capacity, 0)) {
+                    target = capacity;
+                    return _data;
+                }
+            }
+            return alloc.allocate(target);
+        }
+
+        /**
+         * switch to the buffer of grow_buffer(), the elements are relocated into it, and the old buffer is freed
+         */
+        void adopt(T *data, size_type capacity) {
+            if (data != _data) {
+                if (_data) {
+                    relocate(_data, _size, data);
+                    holder::allocator().deallocate(_data, _capacity);
+                }
+                _data = data;
+            }
+            _capacity = capacity;
+        }
+
+    public:
+        vector() : holder(), _data(nullptr), _size(0), _capacity(0) {}
+        explicit vector(const Alloc &alloc) : holder(allocator_type(alloc)), _data(nullptr), _size(0), _capacity(0) {}
+        vector(const vector &other) : holder(other.get_allocator()), _data(nullptr), _size(0), _capacity(0) {
+            if (!reserve(other._size)) return;
+            for (size_type ix = 0; ix < other._size; ++ix) new(_data + ix) T(other._data[ix]);
+            _size = other._size;
+        }
+        vector(vector &&other) noexcept : holder(other.get_allocator()), _data(other._data),
+                                          _size(other._size), _capacity(other._capacity) {
+            other._data = nullptr;
+            other._size = other._capacity = 0;
+        }
+        vector &operator=(const vector &other) {
+            if (this == &other) return *this;
+            clear();
+            if (!reserve(other._size)) return *this;
+            for (size_type ix = 0; ix < other._size; ++ix) new(_data + ix) T(other._data[ix]);
+            _size = other._size;
+            return *this;
+        }
+        vector &operator=(vector &&other) noexcept {
+            if (this == &other) return *this;
+            release();
+            holder::assign(other.get_allocator());
+            _data = other._data; _size = other._size; _capacity = other._capacity;
+            other._data = nullptr;
+            other._size = other._capacity = 0;
+            return *this;
+        }
+        ~vector() { release(); }
+
+        const allocator_type &get_allocator() const { return holder::allocator(); }
+
+        T *data() { return _data; }
+        const T *data() const { return _data; }
+        size_type size() const { return _size; }
+        size_type capacity() const { return _capacity; }
+        bool empty() const { return _size == 0; }
+
+        T &operator[](size_type index) { return _data[index]; }
+        const T &operator[](size_type index) const { return _data[index]; }
+        T &front() { return _data[0]; }
+        T &back() { return _data[_size - 1]; }
+        iterator begin() { return _data; }
+        iterator end() { return _data + _size; }
+        const_iterator begin() const { return _data; }
+        const_iterator end() const { return _data + _size; }
+
+        /**
+         * make room for at least {capacity} elements
+         * @return {false} if the allocation failed
+         */
+        bool reserve(size_type capacity) {
+            if (capacity <= _capacity) return true;
+            allocator_type &alloc = holder::allocator();
+            if (_data && detail::try_expand(alloc, _data, capacity, 0)) {
+                _capacity = capacity;
+                return true;
+            }
+            T *data = alloc.allocate(capacity);
+            if (data == nullptr) return false;
+            if (_data) {
+                relocate(_data, _size, data);
+                alloc.deallocate(_data, _capacity);
+            }
+            _data = data;
+            _capacity = capacity;
+            return true;
+        }
+
+        /**
+         * construct an element at the end
+         * @return {false} if the allocation failed
+         */
+        template<class... Args>
+        bool emplace_back(Args &&... args) {
+            if (_size < _capacity) {
+                new(_data + _size) T(micro_alloc::traits::forward<Args>(args)...);
+                _size += 1;
+                return true;
+            }
+            // {args} may point into the old buffer, so the element is constructed before it is freed
+            size_type capacity;
+            T *data = grow_buffer(_size + 1, capacity);
+            if (data == nullptr) return false;
+            new(data + _size) T(micro_alloc::traits::forward<Args>(args)...);
+            adopt(data, capacity);
+            _size += 1;
+            return true;
+        }
+        bool push_back(const T &value) { return emplace_back(value); }
+        bool push_back(T &&value) { return emplace_back(micro_alloc::traits::move(value)); }
+
+        void pop_back() {
+            _size -= 1;
+            detail::destroy_range(_data + _size, 1);
+        }
+
+        /**
+         * resize to {count} elements, new elements are constructed with {args}
+         * @return {false} if the allocation failed
+         */
+        template<class... Args>
+        bool resize(size_type count, Args &&... args) {
+            if (count < _size) {
+                detail::destroy_range(_data + count, _size - count);
+                _size = count;
+                return true;
+            }
+            T *data = _data;
+            size_type capacity = _capacity;
+            if (count > _capacity && (data = grow_buffer(count, capacity)) == nullptr) return false;
+            detail::construct_range(data + _size, count - _size, micro_alloc::traits::forward<Args>(args)...);
+            adopt(data, capacity);
+            _size = count;
+            return true;
+        }
+
+        /**
+         * destruct all elements, the capacity is kept
+         */
+        void clear() {
+            detail::destroy_range(_data, _size);
+            _size = 0;
+        }
+
+        /**
+         * destruct all elements, and return the buffer to the allocator
+         */
+        void release() {
+            clear();
+            if (_data) holder::allocator().deallocate(_data, _capacity);
+            _data = nullptr;
+            _capacity = 0;
+        }
+    };
+}
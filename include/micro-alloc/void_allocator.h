@@ -10,6 +10,8 @@
 ========================================================================================*/
 #pragma once
 
+#include "traits.h"
+
 namespace micro_alloc {
 
     /**
@@ -21,6 +23,12 @@ namespace micro_alloc {
     public:
         using value_type = T;
         using size_t = unsigned long;
+        using size_type = size_t;
+        using difference_type = long;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::true_type;
 
         template<class U>
         explicit void_allocator(const void_allocator<U> &other) noexcept {};
@@ -39,4 +47,9 @@ namespace micro_alloc {
     bool operator==(const void_allocator<T1> &lhs, const void_allocator<T2> &rhs) noexcept {
         return true;
     }
+
+    template<class T1, class T2>
+    bool operator!=(const void_allocator<T1> &lhs, const void_allocator<T2> &rhs) noexcept {
+        return false;
+    }
 }
\ No newline at end of file